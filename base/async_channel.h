@@ -0,0 +1,216 @@
+#ifndef YARN_BASE_ASYNC_CHANNEL_H_
+#define YARN_BASE_ASYNC_CHANNEL_H_
+
+#include <systemc.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "base/channel.h"
+#include "base/ring_buffer.h"
+
+namespace yarn {
+
+// Channel between a SystemC process and an OS worker thread, so heavy reference model work can run in parallel with
+// the kernel.
+//
+// The SystemC side uses the normal ChannelPut/ChannelGet interface and blocks on an sc_event as usual. The worker side
+// uses Push/Pop (and their Try variants) which never call into the kernel directly: items go through a lock-free
+// single-producer/single-consumer RingBuffer and the SystemC side is woken through async_request_update(), at most
+// once per update phase. Each channel carries one direction with one thread on either end; use one channel per
+// worker. A worker blocked in Push/Pop sleeps on a condition variable that the SystemC side signals when it moves an
+// item, so waiting on an idle simulation costs no CPU; the SystemC side only takes the lock while the worker waits.
+//
+// The channel keeps the simulation from ending by starvation while a worker is attached. The worker calls Close()
+// once it has nothing more to put or get.
+//
+// The channel holds at most depth items, whatever the depth; only the storage behind it is rounded up to a power of
+// two. A depth of zero could never pass an item and is rejected.
+template <typename DataType>
+class AsyncChannel : public sc_prim_channel, public ChannelPut<DataType>, public ChannelGet<DataType> {
+ public:
+  AsyncChannel(const std::string& name, uint64_t depth = 1024)
+      : sc_prim_channel(name.c_str()),
+        name_(name),
+        depth_(depth),
+        queue_(depth),
+        event_(std::string(name_ + "_event").c_str()) {
+    if (!depth) SC_REPORT_ERROR("yarn/async_channel", (name_ + " needs a depth of at least one").c_str());
+    async_attach_suspending();
+  }
+
+  virtual ~AsyncChannel() = default;
+  size_t Size() { return ChannelPut<DataType>::Size(); }  // Note! Either one works
+  std::string Name() { return name_; }
+
+  // Worker side, safe to call from any single OS thread
+
+  bool TryPush(const DataType& d) {
+    if (Full()) return false;
+    queue_.Push(d);
+    Wake();
+    return true;
+  }
+
+  bool TryPush(DataType&& d) {
+    if (Full()) return false;
+    queue_.Push(std::move(d));
+    Wake();
+    return true;
+  }
+
+  // Sleeps until the SystemC side makes room
+  void Push(const DataType& d) {
+    AwaitWorker([this]() { return !Full(); });
+    TryPush(d);
+  }
+
+  void Push(DataType&& d) {
+    AwaitWorker([this]() { return !Full(); });
+    TryPush(std::move(d));
+  }
+
+  bool TryPop(DataType& d) {
+    if (queue_.Empty()) return false;
+    d = std::move(queue_.Front());
+    queue_.Pop();
+    Wake();
+    return true;
+  }
+
+  // Sleeps until the SystemC side puts an item
+  DataType Pop() {
+    AwaitWorker([this]() { return !queue_.Empty(); });
+    DataType returned(std::move(queue_.Front()));
+    queue_.Pop();
+    Wake();
+    return returned;
+  }
+
+  // Lets the simulation end once the SystemC side runs out of work
+  void Close() {
+    if (!closed_.exchange(true)) async_detach_suspending();
+  }
+
+ private:
+  const std::string name_;
+  const uint64_t depth_;
+  RingBuffer<DataType> queue_;
+  std::atomic<bool> update_pending_{false};
+  std::atomic<bool> closed_{false};
+  sc_event event_;
+  std::mutex worker_mutex_;
+  std::condition_variable worker_cv_;
+  std::atomic<bool> worker_waiting_{false};
+
+  bool Full() const { return queue_.Size() >= depth_; }
+
+  void Wake() {
+    if (!update_pending_.exchange(true, std::memory_order_acq_rel)) async_request_update();
+  }
+
+  // The fences pair with the ones in WakeWorker: either the worker sees the queue change or the SystemC side sees the
+  // worker waiting and signals it under the lock, so no wakeup is lost
+  template <typename Ready>
+  void AwaitWorker(Ready ready) {
+    if (ready()) return;
+    std::unique_lock<std::mutex> lock(worker_mutex_);
+    worker_waiting_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    worker_cv_.wait(lock, ready);
+    worker_waiting_.store(false);
+  }
+
+  // Called by the SystemC side after every item it moves
+  void WakeWorker() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!worker_waiting_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    worker_cv_.notify_one();
+  }
+
+  // Runs on the kernel thread in the update phase following a worker Push/Pop
+  void update() override {
+    update_pending_.store(false, std::memory_order_release);
+    event_.notify(SC_ZERO_TIME);
+  }
+
+  // SystemC side
+
+  void Put_(const DataType& d) {
+    while (Full()) wait(event_);
+    queue_.Push(d);
+    WakeWorker();
+  }
+
+  void Put_(DataType&& d) {
+    while (Full()) wait(event_);
+    queue_.Push(std::move(d));
+    WakeWorker();
+  }
+
+  bool TryPut_(const DataType& d) {
+    if (Full()) return false;
+    queue_.Push(d);
+    WakeWorker();
+    return true;
+  }
+
+  bool TryPut_(DataType&& d) {
+    if (Full()) return false;
+    queue_.Push(std::move(d));
+    WakeWorker();
+    return true;
+  }
+
+  bool TryGet_(DataType& d) {
+    if (queue_.Empty()) return false;
+    d = std::move(queue_.Front());
+    queue_.Pop();
+    WakeWorker();
+    return true;
+  }
+
+  bool GetFor_(DataType& d, const sc_time& timeout) {
+    const sc_time deadline = sc_time_stamp() + timeout;
+    while (queue_.Empty()) {
+      const sc_time now = sc_time_stamp();
+      if (now >= deadline) return false;
+      wait(deadline - now, event_);
+    }
+    return TryGet_(d);
+  }
+
+  DataType Get_() {
+    while (queue_.Empty()) wait(event_);
+    DataType returned(std::move(queue_.Front()));
+    queue_.Pop();
+    WakeWorker();
+    return returned;
+  }
+
+  const DataType& Peek_() {
+    while (queue_.Empty()) wait(event_);
+    return queue_.Front();
+  }
+
+  void Consume_() {
+    while (queue_.Empty()) wait(event_);
+    queue_.Pop();
+    WakeWorker();
+  }
+
+  // The worker side is the only one that makes room or adds items, so both directions share one event
+  const sc_event& GetEvent_() const { return event_; }
+  const sc_event& PutEvent_() const { return event_; }
+  std::string Name_() const { return name_; }
+  size_t Size_() const { return queue_.Size(); }
+};
+
+}  // namespace yarn
+
+#endif  // YARN_BASE_ASYNC_CHANNEL_H_
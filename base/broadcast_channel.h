@@ -0,0 +1,182 @@
+#ifndef YARN_BASE_BROADCAST_CHANNEL_H_
+#define YARN_BASE_BROADCAST_CHANNEL_H_
+
+#include <systemc.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/channel.h"
+
+namespace yarn {
+
+// One producer, many consumers, every consumer sees every item.
+//
+// Items are written once into a shared ring; each subscriber only owns a read cursor, so the cost of adding a reader
+// is one counter rather than one more copy of the stream. A slot is reused once the slowest reader has moved past it,
+// which means back-pressure follows the slowest reader.
+//
+// Subscribers see the items put after they subscribed, so subscribe during elaboration. With no subscribers the
+// channel never fills and items are dropped.
+template <typename DataType>
+class BroadcastChannel : public ChannelPut<DataType> {
+ public:
+  BroadcastChannel(const std::string& name, uint64_t depth = 1024)
+      : name_(name),
+        depth_(std::max<uint64_t>(depth, 1)),
+        slots_(RoundUpPow2(depth_)),
+        mask_(slots_.size() - 1),
+        get_event_(std::string(name + "_get_event").c_str()),
+        put_event_(std::string(name + "_put_event").c_str()) {}
+
+  virtual ~BroadcastChannel() = default;
+
+  // Returns the read side for a new subscriber. The reference lives as long as the channel.
+  ChannelGet<DataType>& Subscribe(const std::string& name) {
+    readers_.emplace_back(new Reader(*this, name));
+    return *readers_.back();
+  }
+
+  size_t Subscribers() const { return readers_.size(); }
+
+ private:
+  class Reader : public ChannelGet<DataType> {
+   public:
+    Reader(BroadcastChannel& channel, const std::string& name) : channel_(channel), name_(name), read_(channel.write_) {}
+
+   private:
+    friend class BroadcastChannel;
+
+    BroadcastChannel& channel_;
+    const std::string name_;
+    uint64_t read_;
+
+    // Items are shared with the other readers, so they are copied out rather than moved
+    DataType Get_() {
+      DataType returned(Peek_());
+      Consume_();
+      return returned;
+    }
+
+    const DataType& Peek_() {
+      while (!Size_()) wait(channel_.put_event_);
+      return channel_.slots_[read_ & channel_.mask_];
+    }
+
+    void Consume_() {
+      while (!Size_()) wait(channel_.put_event_);
+      ++read_;
+      channel_.get_event_.notify();
+    }
+
+    bool TryGet_(DataType& d) {
+      if (!Size_()) return false;
+      d = channel_.slots_[read_++ & channel_.mask_];
+      channel_.get_event_.notify();
+      return true;
+    }
+
+    bool GetFor_(DataType& d, const sc_time& timeout) {
+      const sc_time deadline = sc_time_stamp() + timeout;
+      while (!Size_()) {
+        const sc_time now = sc_time_stamp();
+        if (now >= deadline) return false;
+        wait(deadline - now, channel_.put_event_);
+      }
+      return TryGet_(d);
+    }
+
+    size_t GetN_(DataType* out, size_t max) {
+      if (!max) return 0;
+      while (!Size_()) wait(channel_.put_event_);
+      const size_t n = std::min<size_t>(max, Size_());
+      for (size_t i = 0; i < n; ++i) out[i] = channel_.slots_[(read_ + i) & channel_.mask_];
+      read_ += n;
+      channel_.get_event_.notify();
+      return n;
+    }
+
+    const sc_event& PutEvent_() const { return channel_.put_event_; }
+    std::string Name_() const { return name_; }
+    size_t Size_() const { return channel_.write_ - read_; }
+  };
+
+  const std::string name_;
+  const uint64_t depth_;
+  std::vector<DataType> slots_;
+  const uint64_t mask_;
+  std::vector<std::unique_ptr<Reader>> readers_;
+  uint64_t write_ = 0;
+  // Cursor of the slowest reader, only refreshed when the ring looks full
+  uint64_t slowest_ = 0;
+  sc_event get_event_;
+  sc_event put_event_;
+
+  static size_t RoundUpPow2(uint64_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  uint64_t Room() {
+    if (write_ - slowest_ >= depth_) {
+      slowest_ = write_;
+      for (const auto& r : readers_) slowest_ = std::min(slowest_, r->read_);
+    }
+    return depth_ - (write_ - slowest_);
+  }
+
+  void Put_(const DataType& d) {
+    while (!Room()) wait(get_event_);
+    slots_[write_++ & mask_] = d;
+    put_event_.notify();
+  }
+
+  void Put_(DataType&& d) {
+    while (!Room()) wait(get_event_);
+    slots_[write_++ & mask_] = std::move(d);
+    put_event_.notify();
+  }
+
+  bool TryPut_(const DataType& d) {
+    if (!Room()) return false;
+    slots_[write_++ & mask_] = d;
+    put_event_.notify();
+    return true;
+  }
+
+  bool TryPut_(DataType&& d) {
+    if (!Room()) return false;
+    slots_[write_++ & mask_] = std::move(d);
+    put_event_.notify();
+    return true;
+  }
+
+  void PutN_(const DataType* d, size_t n) {
+    while (n) {
+      uint64_t room;
+      while (!(room = Room())) wait(get_event_);
+      const size_t chunk = std::min<uint64_t>(n, room);
+      for (size_t i = 0; i < chunk; ++i) slots_[write_++ & mask_] = d[i];
+      d += chunk;
+      n -= chunk;
+      put_event_.notify();
+    }
+  }
+
+  const sc_event& GetEvent_() const { return get_event_; }
+  std::string Name_() const { return name_; }
+  // Occupancy as seen by the producer, i.e. what the slowest reader still has to read
+  size_t Size_() const {
+    uint64_t slowest = write_;
+    for (const auto& r : readers_) slowest = std::min(slowest, r->read_);
+    return write_ - slowest;
+  }
+};
+
+}  // namespace yarn
+
+#endif  // YARN_BASE_BROADCAST_CHANNEL_H_
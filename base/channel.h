@@ -1,6 +1,20 @@
 #ifndef YARN_BASE_CHANNEL_H_
 #define YARN_BASE_CHANNEL_H_
 
+#include <systemc.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/channel_stats.h"
+#include "base/ring_buffer.h"
+
 //  Note! This is inspired by
 //  [truss_channel.h](https://github.com/trusster/trusster/blob/master/truss/cpp/inc/truss_channel.h)
 
@@ -11,11 +25,34 @@ class ChannelPut {
  public:
   virtual ~ChannelPut() = default;
   void Put(const data_type& d) { Put_(d); }
+  void Put(data_type&& d) { Put_(std::move(d)); }
+  // Constructs the item from args. Channel hides this with a version that constructs directly in its storage.
+  template <typename... Args>
+  void Emplace(Args&&... args) {
+    Put_(data_type(std::forward<Args>(args)...));
+  }
+  // Puts a whole burst with a single dispatch. Blocks until all n items have been accepted.
+  void PutN(const data_type* d, size_t n) { PutN_(d, n); }
+  void PutN(const std::vector<data_type>& d) { PutN_(d.data(), d.size()); }
+  // Never blocks, so it is usable from an SC_METHOD. Returns false (and leaves d untouched) when the channel is full.
+  bool TryPut(const data_type& d) { return TryPut_(d); }
+  bool TryPut(data_type&& d) { return TryPut_(std::move(d)); }
+  // Notified whenever room is made; SC_METHOD producers use it with next_trigger() after a failed TryPut
+  const sc_event& GetEvent() { return GetEvent_(); }
   size_t Size() { return Size_(); }
   std::string Name() { return Name_(); }
 
  protected:
   virtual void Put_(const data_type& d) = 0;
+  // Fallback for endpoints that cannot take ownership
+  virtual void Put_(data_type&& d) { Put_(static_cast<const data_type&>(d)); }
+  // Fallback for endpoints without a bulk path
+  virtual void PutN_(const data_type* d, size_t n) {
+    for (size_t i = 0; i < n; ++i) Put_(d[i]);
+  }
+  virtual bool TryPut_(const data_type& d) = 0;
+  virtual bool TryPut_(data_type&& d) = 0;
+  virtual const sc_event& GetEvent_() const = 0;
   virtual size_t Size_() const = 0;
   virtual std::string Name_() const = 0;
 };
@@ -25,50 +62,246 @@ class ChannelGet {
  public:
   virtual ~ChannelGet() = default;
   data_type Get() { return Get_(); }
+  // Blocks until an item is available and returns a reference to it in the channel storage. The reference stays valid
+  // until Consume() (or any other get) removes the item; this lets large items be read without a copy.
+  const data_type& Peek() { return Peek_(); }
+  void Consume() { Consume_(); }
+  // Blocks until at least one item is available, then moves up to max items into out. Returns the number moved.
+  size_t GetN(data_type* out, size_t max) { return GetN_(out, max); }
+  // Never blocks, so it is usable from an SC_METHOD. Returns false when the channel is empty.
+  bool TryGet(data_type& d) { return TryGet_(d); }
+  // Waits at most timeout for an item. Returns false if none arrived in time.
+  bool Get(data_type& d, const sc_time& timeout) { return GetFor_(d, timeout); }
+  // Notified whenever an item is put; SC_METHOD consumers use it with next_trigger() after a failed TryGet
+  const sc_event& PutEvent() { return PutEvent_(); }
   size_t Size() { return Size_(); }
   std::string Name() { return Name_(); }
 
  protected:
   virtual data_type Get_() = 0;
+  virtual const data_type& Peek_() = 0;
+  virtual void Consume_() = 0;
+  // Fallback for endpoints without a bulk path
+  virtual size_t GetN_(data_type* out, size_t max) {
+    if (!max) return 0;
+    size_t n = 0;
+    out[n++] = Get_();
+    while (n < max && Size_()) out[n++] = Get_();
+    return n;
+  }
+  virtual bool TryGet_(data_type& d) = 0;
+  virtual bool GetFor_(data_type& d, const sc_time& timeout) = 0;
+  virtual const sc_event& PutEvent_() const = 0;
   virtual size_t Size_() const = 0;
   virtual std::string Name_() const = 0;
 };
 
+// Observes every item that enters a channel (e.g. yarn::TraceRecorder)
+template <class data_type>
+class ChannelMonitor {
+ public:
+  virtual ~ChannelMonitor() = default;
+  virtual void OnPut(const data_type* d, size_t n) = 0;
+};
+
+// Bounded channels (depth up to kMaxRingDepth) keep their items in a preallocated RingBuffer and never allocate after
+// construction. Unbounded channels, and channels deeper than is sensible to allocate up front, use a std::deque. A
+// depth of zero could never pass an item and is rejected.
+// Traffic is counted in a ChannelStats when built with YARN_CHANNEL_STATS (see base/channel_stats.h).
+//
+// Move-only items go through the rvalue Put/TryPut and Emplace; a copying put of one through the ChannelPut interface
+// is reported as an error.
+//
+// Channel is final and repeats the hot Put/Get front ends as non-virtual members, so code holding a Channel (rather
+// than a ChannelPut/ChannelGet reference) calls straight into the implementation and can inline it.
 template <typename DataType>
-class Channel : public ChannelPut<DataType>, public ChannelGet<DataType> {
+class Channel final : public ChannelPut<DataType>, public ChannelGet<DataType> {
  public:
+  static constexpr uint64_t kMaxRingDepth = uint64_t{1} << 20;
+
   Channel(const std::string& name, uint64_t depth = std::numeric_limits<uint64_t>::max())
       : name_(name),
         depth_(depth),
+        use_ring_(depth <= kMaxRingDepth),
+        ring_(use_ring_ ? depth : 0),
         get_event_(std::string(name + "_get_event").c_str()),
-        put_event_(std::string(name + "_put_event").c_str()) {};
+        put_event_(std::string(name + "_put_event").c_str()),
+        stats_(name) {
+    if (!depth) SC_REPORT_ERROR("yarn/channel", (name_ + " needs a depth of at least one").c_str());
+  }
 
   virtual ~Channel() = default;
   size_t Size() { return ChannelPut<DataType>::Size(); }  // Note! Either one works
+  std::string Name() { return name_; }
+
+  using ChannelPut<DataType>::Put;
+  void Put(const DataType& d) { Emplace(d); }
+  void Put(DataType&& d) { Emplace(std::move(d)); }
+  using ChannelGet<DataType>::Get;
+  DataType Get() { return Get_(); }
+  bool TryGet(DataType& d) { return TryGet_(d); }
+  const DataType& Peek() { return Peek_(); }
+
+  // Reports every item put from now on to monitor; nullptr detaches. The monitor must outlive the channel's use.
+  void Attach(ChannelMonitor<DataType>* monitor) { monitor_ = monitor; }
+
+  // Constructs the item in place in the channel storage
+  template <typename... Args>
+  void Emplace(Args&&... args) {
+    AwaitRoom();
+    const DataType& item = Push(std::forward<Args>(args)...);
+    if (monitor_) monitor_->OnPut(&item, 1);
+    stats_.OnPut(1, Size_());
+    put_event_.notify();
+  }
 
  private:
   const std::string name_;
   const uint64_t depth_;
+  const bool use_ring_;
+  RingBuffer<DataType> ring_;
   std::deque<DataType> storage_;
   sc_event get_event_;
   sc_event put_event_;
+  ChannelStats stats_;
+  ChannelMonitor<DataType>* monitor_ = nullptr;
 
   void Put_(const DataType& d) {
-    if (Size() >= depth_) wait(get_event_);
-    storage_.push_back(d);
+    if constexpr (std::is_copy_constructible<DataType>::value)
+      Emplace(d);
+    else
+      CannotCopy();
+  }
+  void Put_(DataType&& d) { Emplace(std::move(d)); }
+
+  bool TryPut_(const DataType& d) {
+    if constexpr (std::is_copy_constructible<DataType>::value)
+      return TryEmplace(d);
+    else
+      return CannotCopy();
+  }
+  bool TryPut_(DataType&& d) { return TryEmplace(std::move(d)); }
+
+  // Leaves args untouched when the channel is full
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    if (Size() >= depth_) return false;
+    const DataType& item = Push(std::forward<Args>(args)...);
+    if (monitor_) monitor_->OnPut(&item, 1);
+    stats_.OnPut(1, Size_());
     put_event_.notify();
+    return true;
+  }
+
+  // Fills whatever room there is, notifies once and only waits when the channel is full
+  void PutN_(const DataType* d, size_t n) {
+    if constexpr (!std::is_copy_constructible<DataType>::value) {
+      CannotCopy();
+    } else {
+      while (n) {
+        AwaitRoom();
+        const size_t chunk = std::min<uint64_t>(n, depth_ - Size());
+        for (size_t i = 0; i < chunk; ++i) Push(d[i]);
+        if (monitor_) monitor_->OnPut(d, chunk);
+        d += chunk;
+        n -= chunk;
+        stats_.OnPut(chunk, Size_());
+        put_event_.notify();
+      }
+    }
+  }
+
+  size_t GetN_(DataType* out, size_t max) {
+    if (!max) return 0;
+    AwaitData();
+    const size_t n = std::min(max, Size_());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = std::move(Front());
+      PopFront();
+    }
+    stats_.OnGet(n, Size_());
+    get_event_.notify();
+    return n;
   }
 
   DataType Get_() {
-    while (!Size()) wait(put_event_);
-    DataType returned(storage_.front());
-    storage_.pop_front();
+    AwaitData();
+    DataType returned(std::move(Front()));
+    PopFront();
+    stats_.OnGet(1, Size_());
     get_event_.notify();
     return returned;
   }
 
+  bool TryGet_(DataType& d) {
+    if (!Size()) return false;
+    d = std::move(Front());
+    PopFront();
+    stats_.OnGet(1, Size_());
+    get_event_.notify();
+    return true;
+  }
+
+  bool GetFor_(DataType& d, const sc_time& timeout) {
+    if (!Size()) {
+      const auto token = stats_.BeginWait();
+      const sc_time deadline = sc_time_stamp() + timeout;
+      while (!Size() && sc_time_stamp() < deadline) wait(deadline - sc_time_stamp(), put_event_);
+      stats_.EndGetWait(token);
+    }
+    return TryGet_(d);
+  }
+
+  const DataType& Peek_() {
+    AwaitData();
+    return Front();
+  }
+
+  void Consume_() {
+    AwaitData();
+    PopFront();
+    stats_.OnGet(1, Size_());
+    get_event_.notify();
+  }
+
+  bool CannotCopy() const {
+    SC_REPORT_ERROR("yarn/channel", (name_ + ": items are move-only, put them as rvalues or with Emplace()").c_str());
+    return false;
+  }
+
+  void AwaitRoom() {
+    if (Size() < depth_) return;
+    const auto token = stats_.BeginWait();
+    while (Size() >= depth_) wait(get_event_);
+    stats_.EndPutWait(token);
+  }
+
+  void AwaitData() {
+    if (Size()) return;
+    const auto token = stats_.BeginWait();
+    while (!Size()) wait(put_event_);
+    stats_.EndGetWait(token);
+  }
+
+  template <typename... Args>
+  DataType& Push(Args&&... args) {
+    if (use_ring_) return ring_.Emplace(std::forward<Args>(args)...);
+    return storage_.emplace_back(std::forward<Args>(args)...);
+  }
+
+  DataType& Front() { return use_ring_ ? ring_.Front() : storage_.front(); }
+
+  void PopFront() {
+    if (use_ring_)
+      ring_.Pop();
+    else
+      storage_.pop_front();
+  }
+
+  const sc_event& GetEvent_() const { return get_event_; }
+  const sc_event& PutEvent_() const { return put_event_; }
   std::string Name_() const { return name_; }
-  size_t Size_() const { return storage_.size(); }
+  size_t Size_() const { return use_ring_ ? ring_.Size() : storage_.size(); }
 };
 
 }  // namespace yarn
@@ -0,0 +1,167 @@
+#ifndef YARN_BASE_CHANNEL_STATS_H_
+#define YARN_BASE_CHANNEL_STATS_H_
+
+#include <systemc.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Per-channel occupancy and latency counters.
+//
+// Build with YARN_CHANNEL_STATS defined to turn them on. Otherwise ChannelStats is an empty class whose hooks are empty
+// inline functions, and an instrumented channel compiles to exactly the code it had before.
+//
+// Call yarn::DumpChannelStats() (e.g. from sc_main after sc_start returns) to print every live channel.
+
+namespace yarn {
+
+enum class StatsFormat { kTable, kJson };
+
+#ifdef YARN_CHANNEL_STATS
+
+class ChannelStats {
+ public:
+  // Latency bucket i holds items that spent [2^(i-1), 2^i) sim-time resolution units in the channel; bucket 0 holds
+  // items that left in the same time step they arrived.
+  static constexpr size_t kLatencyBuckets = 64;
+
+  // Marks the start of a blocking wait
+  struct WaitToken {
+    sc_time start;
+  };
+
+  explicit ChannelStats(const std::string& name) : name_(name) { Registry().push_back(this); }
+  ~ChannelStats() {
+    auto& all = Registry();
+    all.erase(std::remove(all.begin(), all.end(), this), all.end());
+  }
+
+  ChannelStats(const ChannelStats&) = delete;
+  ChannelStats& operator=(const ChannelStats&) = delete;
+
+  void OnPut(size_t n, size_t occupancy) {
+    puts_ += n;
+    Sample(occupancy);
+    const uint64_t now = sc_time_stamp().value();
+    for (size_t i = 0; i < n; ++i) put_times_.push_back(now);
+  }
+
+  void OnGet(size_t n, size_t occupancy) {
+    gets_ += n;
+    Sample(occupancy);
+    const uint64_t now = sc_time_stamp().value();
+    for (size_t i = 0; i < n && !put_times_.empty(); ++i) {
+      ++latency_[Bucket(now - put_times_.front())];
+      put_times_.pop_front();
+    }
+  }
+
+  WaitToken BeginWait() const { return {sc_time_stamp()}; }
+  void EndPutWait(const WaitToken& token) { put_blocked_ += sc_time_stamp() - token.start; }
+  void EndGetWait(const WaitToken& token) { get_blocked_ += sc_time_stamp() - token.start; }
+
+  const std::string& Name() const { return name_; }
+  uint64_t Puts() const { return puts_; }
+  uint64_t Gets() const { return gets_; }
+  size_t MaxOccupancy() const { return max_occupancy_; }
+  double AverageOccupancy() const { return samples_ ? static_cast<double>(occupancy_sum_) / samples_ : 0.0; }
+  // Time producers spent waiting for room
+  const sc_time& PutBlocked() const { return put_blocked_; }
+  // Time consumers spent waiting for data
+  const sc_time& GetBlocked() const { return get_blocked_; }
+  const std::array<uint64_t, kLatencyBuckets>& Latency() const { return latency_; }
+
+  static std::vector<ChannelStats*>& Registry() {
+    static std::vector<ChannelStats*> registry;
+    return registry;
+  }
+
+ private:
+  static size_t Bucket(uint64_t latency) {
+    size_t bucket = 0;
+    while (latency && bucket < kLatencyBuckets - 1) {
+      latency >>= 1;
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  void Sample(size_t occupancy) {
+    max_occupancy_ = std::max(max_occupancy_, occupancy);
+    occupancy_sum_ += occupancy;
+    ++samples_;
+  }
+
+  const std::string name_;
+  uint64_t puts_ = 0;
+  uint64_t gets_ = 0;
+  size_t max_occupancy_ = 0;
+  uint64_t occupancy_sum_ = 0;
+  uint64_t samples_ = 0;
+  sc_time put_blocked_;
+  sc_time get_blocked_;
+  std::deque<uint64_t> put_times_;
+  std::array<uint64_t, kLatencyBuckets> latency_{};
+};
+
+inline void DumpChannelStats(std::ostream& os, StatsFormat format = StatsFormat::kTable) {
+  const auto& all = ChannelStats::Registry();
+  if (format == StatsFormat::kJson) {
+    os << "[";
+    for (size_t i = 0; i < all.size(); ++i) {
+      const ChannelStats& s = *all[i];
+      os << (i ? ",\n " : "\n ") << "{\"name\": \"" << s.Name() << "\", \"puts\": " << s.Puts()
+         << ", \"gets\": " << s.Gets() << ", \"max_occupancy\": " << s.MaxOccupancy()
+         << ", \"avg_occupancy\": " << s.AverageOccupancy() << ", \"put_blocked_s\": " << s.PutBlocked().to_seconds()
+         << ", \"get_blocked_s\": " << s.GetBlocked().to_seconds() << ", \"latency_log2\": [";
+      size_t last = 0;
+      for (size_t b = 0; b < ChannelStats::kLatencyBuckets; ++b)
+        if (s.Latency()[b]) last = b + 1;
+      for (size_t b = 0; b < last; ++b) os << (b ? ", " : "") << s.Latency()[b];
+      os << "]}";
+    }
+    os << "\n]\n";
+    return;
+  }
+  const std::ios_base::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  os << std::left << std::setw(32) << "channel" << std::right << std::setw(14) << "puts" << std::setw(14) << "gets"
+     << std::setw(8) << "max" << std::setw(10) << "avg" << std::setw(20) << "put blocked" << std::setw(20)
+     << "get blocked" << "\n";
+  for (const ChannelStats* s : all) {
+    os << std::left << std::setw(32) << s->Name() << std::right << std::setw(14) << s->Puts() << std::setw(14)
+       << s->Gets() << std::setw(8) << s->MaxOccupancy() << std::setw(10) << std::fixed << std::setprecision(2)
+       << s->AverageOccupancy() << std::setw(20) << s->PutBlocked() << std::setw(20) << s->GetBlocked() << "\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+#else  // YARN_CHANNEL_STATS
+
+class ChannelStats {
+ public:
+  struct WaitToken {};
+
+  explicit ChannelStats(const std::string&) {}
+
+  void OnPut(size_t, size_t) {}
+  void OnGet(size_t, size_t) {}
+  WaitToken BeginWait() const { return {}; }
+  void EndPutWait(const WaitToken&) {}
+  void EndGetWait(const WaitToken&) {}
+};
+
+inline void DumpChannelStats(std::ostream&, StatsFormat = StatsFormat::kTable) {}
+
+#endif  // YARN_CHANNEL_STATS
+
+}  // namespace yarn
+
+#endif  // YARN_BASE_CHANNEL_STATS_H_
@@ -0,0 +1,88 @@
+#ifndef YARN_BASE_RING_BUFFER_H_
+#define YARN_BASE_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace yarn {
+
+// Size used to keep producer and consumer state on separate cache lines. std::hardware_destructive_interference_size
+// is not reliably available (and GCC warns about its ABI stability), so use the common x86/ARM value.
+constexpr size_t kCacheLineSize = 64;
+
+// Fixed capacity FIFO backed by a power-of-two array of uninitialized slots.
+//
+// All storage is allocated up front; Push/Pop never touch the allocator, so a channel built on top of it allocates
+// nothing in steady state. Head and tail are free-running counters on their own cache lines: the size is a single
+// subtraction and wrapping is a mask. The producer only writes tail_ and the consumer only writes head_, which makes
+// the buffer safe for one producer and one consumer on different threads.
+//
+// Callers are responsible for checking Full()/Empty() before Push/Pop.
+template <typename T>
+class RingBuffer {
+ public:
+  // Capacity is rounded up to the next power of two. A zero capacity buffer allocates nothing and is always full.
+  explicit RingBuffer(size_t min_capacity = 0)
+      : capacity_(min_capacity ? RoundUpPow2(min_capacity) : 0),
+        mask_(capacity_ ? capacity_ - 1 : 0),
+        slots_(capacity_ ? new Slot[capacity_] : nullptr) {}
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+
+  ~RingBuffer() {
+    while (!Empty()) Pop();
+  }
+
+  size_t Capacity() const { return capacity_; }
+  size_t Size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+  bool Empty() const { return Size() == 0; }
+  bool Full() const { return Size() >= capacity_; }
+
+  template <typename... Args>
+  T& Emplace(Args&&... args) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    T* item = new (slots_[tail & mask_].bytes) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return *item;
+  }
+
+  void Push(const T& item) { Emplace(item); }
+  void Push(T&& item) { Emplace(std::move(item)); }
+
+  T& Front() { return *At(head_.load(std::memory_order_relaxed)); }
+  const T& Front() const { return *At(head_.load(std::memory_order_relaxed)); }
+
+  void Pop() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    At(head)->~T();
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+ private:
+  struct Slot {
+    alignas(T) unsigned char bytes[sizeof(T)];
+  };
+
+  static size_t RoundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  T* At(size_t index) const { return std::launder(reinterpret_cast<T*>(slots_[index & mask_].bytes)); }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace yarn
+
+#endif  // YARN_BASE_RING_BUFFER_H_
@@ -0,0 +1,245 @@
+#ifndef YARN_BASE_TRACE_H_
+#define YARN_BASE_TRACE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <systemc.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "base/channel.h"
+
+// Binary channel traces.
+//
+// A trace file is a 64 byte TraceHeader followed by an array of TraceRecord<T>, one per item that entered the recorded
+// channel, each stamped with the sim time (in sc_time resolution units) it was put. Records are written as-is, so the
+// file is only portable between builds with the same T layout; the header carries the record size to catch mismatches.
+//
+// TraceRecorder attaches to a yarn::Channel and streams its traffic to a file. TraceReader maps a file read-only and
+// TraceReplay serves it back through the ChannelGet interface, so a recorded stream can drive a model on its own.
+
+namespace yarn {
+
+constexpr char kTraceMagic[8] = {'Y', 'A', 'R', 'N', 'T', 'R', 'C', '\0'};
+constexpr uint32_t kTraceVersion = 1;
+
+struct TraceHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint64_t resolution_fs;  // Length of one time unit in femtoseconds
+  uint64_t count;          // Number of records, 0 if the recorder was not closed cleanly
+  uint8_t reserved[32];
+};
+static_assert(sizeof(TraceHeader) == 64, "records must start on a cache line");
+
+template <typename T>
+struct TraceRecord {
+  uint64_t time;
+  T data;
+};
+
+template <typename T>
+class TraceRecorder : public ChannelMonitor<T> {
+  static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable items can be traced");
+
+ public:
+  explicit TraceRecorder(const std::string& file_name) : file_name_(file_name), file_(fopen(file_name.c_str(), "wb")) {
+    if (!file_) {
+      failed_ = true;
+      SC_REPORT_ERROR("yarn/trace", ("Cannot open " + file_name_ + " for writing").c_str());
+      return;
+    }
+    setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+    TraceHeader header = {};
+    std::memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    header.version = kTraceVersion;
+    header.record_size = sizeof(TraceRecord<T>);
+    header.resolution_fs = static_cast<uint64_t>(sc_time::from_value(1).to_seconds() * 1e15 + 0.5);
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) failed_ = true;
+  }
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  // Reports a failure as a warning, since an error may be thrown and must not leave a destructor
+  ~TraceRecorder() {
+    if (file_ && !Finish()) SC_REPORT_WARNING("yarn/trace", ("Cannot write trace " + file_name_).c_str());
+  }
+
+  // Records a burst of items that entered the channel at the current sim time
+  void OnPut(const T* d, size_t n) override {
+    if (!file_ || failed_) return;
+    TraceRecord<T> record;
+    std::memset(&record, 0, sizeof(record));
+    record.time = sc_time_stamp().value();
+    for (size_t i = 0; i < n; ++i) {
+      record.data = d[i];
+      if (fwrite(&record, sizeof(record), 1, file_) != 1) {
+        failed_ = true;
+        return;
+      }
+      ++count_;
+    }
+  }
+
+  // Patches the record count into the header and closes the file. Returns false, after reporting an error, if any
+  // part of the trace could not be written; the records written up to the failure stay readable.
+  bool Close() {
+    if (file_ && !Finish()) SC_REPORT_ERROR("yarn/trace", ("Cannot write trace " + file_name_).c_str());
+    return !failed_;
+  }
+
+  // Number of records written
+  uint64_t Count() const { return count_; }
+
+ private:
+  const std::string file_name_;
+  FILE* file_;
+  uint64_t count_ = 0;
+  bool failed_ = false;
+
+  bool Finish() {
+    if (fseek(file_, offsetof(TraceHeader, count), SEEK_SET) != 0 || fwrite(&count_, sizeof(count_), 1, file_) != 1)
+      failed_ = true;
+    if (fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+    return !failed_;
+  }
+};
+
+// Read-only memory-mapped view of a trace file
+template <typename T>
+class TraceReader {
+ public:
+  explicit TraceReader(const std::string& file_name) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TraceHeader)) {
+      SC_REPORT_ERROR("yarn/trace", ("Cannot read trace " + file_name).c_str());
+      if (fd >= 0) close(fd);
+      return;
+    }
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      SC_REPORT_ERROR("yarn/trace", ("Cannot map trace " + file_name).c_str());
+      return;
+    }
+    map_ = map;
+    map_size_ = st.st_size;
+    madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const TraceHeader*>(map_);
+    if (std::memcmp(header->magic, kTraceMagic, sizeof(kTraceMagic)) || header->version != kTraceVersion ||
+        header->record_size != sizeof(TraceRecord<T>)) {
+      SC_REPORT_ERROR("yarn/trace", (file_name + " is not a version " + std::to_string(kTraceVersion) +
+                                     " trace of records of size " + std::to_string(sizeof(TraceRecord<T>)))
+                                        .c_str());
+      return;
+    }
+    resolution_fs_ = header->resolution_fs;
+    records_ = reinterpret_cast<const TraceRecord<T>*>(static_cast<const char*>(map_) + sizeof(TraceHeader));
+    // A recorder that did not close cleanly leaves count at 0; trust the file size then
+    const size_t available = (map_size_ - sizeof(TraceHeader)) / sizeof(TraceRecord<T>);
+    size_ = header->count ? std::min<size_t>(header->count, available) : available;
+  }
+
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  ~TraceReader() {
+    if (map_) munmap(map_, map_size_);
+  }
+
+  bool IsOpen() const { return records_ != nullptr; }
+  size_t Size() const { return size_; }
+  uint64_t ResolutionFs() const { return resolution_fs_; }
+  const TraceRecord<T>* begin() const { return records_; }
+  const TraceRecord<T>* end() const { return records_ + size_; }
+  const TraceRecord<T>& operator[](size_t i) const { return records_[i]; }
+
+ private:
+  void* map_ = nullptr;
+  size_t map_size_ = 0;
+  const TraceRecord<T>* records_ = nullptr;
+  size_t size_ = 0;
+  uint64_t resolution_fs_ = 0;
+};
+
+// Serves a recorded trace through ChannelGet as fast as the consumer reads it (recorded timestamps are not replayed).
+// Once the trace is exhausted it behaves like a drained channel and blocking gets wait forever.
+template <typename T>
+class TraceReplay final : public ChannelGet<T> {
+ public:
+  TraceReplay(const std::string& name, const std::string& file_name)
+      : name_(name), reader_(file_name), never_(std::string(name + "_put_event").c_str()) {}
+
+  using ChannelGet<T>::Get;
+  T Get() { return Get_(); }
+  size_t Remaining() const { return reader_.Size() - pos_; }
+
+ private:
+  const std::string name_;
+  TraceReader<T> reader_;
+  size_t pos_ = 0;
+  sc_event never_;  // Nothing is ever put into a replay
+
+  void AwaitData() {
+    if (!Remaining()) wait(never_);
+  }
+
+  T Get_() {
+    AwaitData();
+    return reader_[pos_++].data;
+  }
+
+  const T& Peek_() {
+    AwaitData();
+    return reader_[pos_].data;
+  }
+
+  void Consume_() {
+    AwaitData();
+    ++pos_;
+  }
+
+  size_t GetN_(T* out, size_t max) {
+    if (!max) return 0;
+    AwaitData();
+    const size_t n = std::min(max, Remaining());
+    for (size_t i = 0; i < n; ++i) out[i] = reader_[pos_ + i].data;
+    pos_ += n;
+    return n;
+  }
+
+  bool TryGet_(T& d) {
+    if (!Remaining()) return false;
+    d = reader_[pos_++].data;
+    return true;
+  }
+
+  bool GetFor_(T& d, const sc_time& timeout) {
+    if (!Remaining()) {
+      wait(timeout);
+      return false;
+    }
+    return TryGet_(d);
+  }
+
+  const sc_event& PutEvent_() const { return never_; }
+  std::string Name_() const { return name_; }
+  size_t Size_() const { return Remaining(); }
+};
+
+}  // namespace yarn
+
+#endif  // YARN_BASE_TRACE_H_
@@ -0,0 +1,148 @@
+// Microbenchmarks for channels, reference models and logging. Only built when configured with
+// -DYARN_BUILD_BENCHMARKS=ON.
+//
+// Every benchmark body runs inside one SC_THREAD, so blocking channel calls and waits behave exactly as they do in a
+// model. Modules have to exist before sc_start(), so the end-to-end fixtures are elaborated up front and driven from
+// the benchmark thread.
+//
+// Takes the usual Google Benchmark flags; keep a machine readable record for regression tracking with
+//   yarn_benchmarks --benchmark_out=yarn_benchmarks.json --benchmark_out_format=json
+// (the console keeps the human readable table).
+
+#include <benchmark/benchmark.h>
+#include <systemc.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "base/channel.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "models/pin_capture/pin_capture.h"
+
+namespace {
+
+// Channels
+
+void BM_ChannelPutGet(benchmark::State& state) {
+  const uint64_t depth = state.range(0);
+  yarn::Channel<uint64_t> channel("channel", depth);
+  uint64_t sum = 0;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < depth; ++i) channel.Put(i);
+    for (uint64_t i = 0; i < depth; ++i) sum += channel.Get();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+// 1 << 21 is past yarn::Channel::kMaxRingDepth and exercises the deque fallback
+BENCHMARK(BM_ChannelPutGet)->Arg(1)->Arg(16)->Arg(1024)->Arg(1 << 21);
+
+void BM_ChannelPutNGetN(benchmark::State& state) {
+  const uint64_t depth = state.range(0);
+  yarn::Channel<uint64_t> channel("channel", depth);
+  std::vector<uint64_t> in(depth), out(depth);
+  for (uint64_t i = 0; i < depth; ++i) in[i] = i;
+  for (auto _ : state) {
+    channel.PutN(in.data(), depth);
+    for (size_t got = 0; got < depth;) got += channel.GetN(out.data() + got, depth - got);
+  }
+  benchmark::DoNotOptimize(out.data());
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_ChannelPutNGetN)->Arg(16)->Arg(1024)->Arg(1 << 16);
+
+// Reference models
+
+// A ChannelReferenceAgent with its input and output channels. The agent runs as a method process; the benchmark thread
+// feeds it running BOCs and blocks on the output, so each batch costs a full round trip through the scheduler.
+struct PinCaptureFixture {
+  static constexpr size_t kBatch = 1024;
+
+  yarn::Channel<period_generator::Transaction> bocs{"pin_capture_bocs", kBatch};
+  yarn::Channel<state_bus::Transaction> state_bus{"pin_capture_state_bus", kBatch};
+  yarn::Channel<pin_capture::Transaction> out{"pin_capture_out", kBatch};
+  pin_capture::ChannelReferenceAgent agent{"pin_capture", bocs, state_bus, out};
+};
+
+PinCaptureFixture* pin_capture_fixture = nullptr;
+
+void BM_PinCaptureReferenceAgent(benchmark::State& state) {
+  PinCaptureFixture& fixture = *pin_capture_fixture;
+  std::vector<period_generator::Transaction> bocs(PinCaptureFixture::kBatch);
+  std::vector<state_bus::Transaction> state_bus(PinCaptureFixture::kBatch);
+  std::vector<pin_capture::Transaction> out(PinCaptureFixture::kBatch);
+  for (size_t i = 0; i < bocs.size(); ++i) {
+    bocs[i].boc_count = i;
+    bocs[i].is_running = true;
+    bocs[i].residue = i & 0xff;
+    state_bus[i] = {static_cast<uint32_t>(i), 0};
+  }
+  for (auto _ : state) {
+    fixture.state_bus.PutN(state_bus.data(), state_bus.size());
+    fixture.bocs.PutN(bocs.data(), bocs.size());
+    for (size_t got = 0; got < out.size();) got += fixture.out.GetN(out.data() + got, out.size() - got);
+  }
+  benchmark::DoNotOptimize(out.data());
+  state.SetItemsProcessed(state.iterations() * PinCaptureFixture::kBatch);
+  state.SetLabel("items are BOCs");
+}
+BENCHMARK(BM_PinCaptureReferenceAgent);
+
+// Logging. The suite runs at INFO, so SCP_INFO goes all the way out and SCP_DEBUG is filtered at the call site. Infos
+// are only written to a file sink on /dev/null (see sc_main), so they measure the logger and not the terminal.
+
+struct LogSite {
+  SCP_LOGGER();
+
+  void Info(int64_t i) { SCP_INFO(()) << "benchmark message " << i; }
+  void Debug(int64_t i) { SCP_DEBUG(()) << "benchmark message " << i; }
+};
+
+void BM_LogInfoEnabled(benchmark::State& state) {
+  LogSite site;
+  int64_t i = 0;
+  for (auto _ : state) site.Info(i++);
+}
+BENCHMARK(BM_LogInfoEnabled);
+
+void BM_LogDebugFiltered(benchmark::State& state) {
+  LogSite site;
+  int64_t i = 0;
+  for (auto _ : state) site.Debug(i++);
+}
+BENCHMARK(BM_LogDebugFiltered);
+
+// The uncached form looks the verbosity up by name on every call
+void BM_LogDebugFilteredUncached(benchmark::State& state) {
+  int64_t i = 0;
+  for (auto _ : state) SCP_DEBUG("benchmark") << "benchmark message " << i++;
+}
+BENCHMARK(BM_LogDebugFilteredUncached);
+
+class BenchmarkRunner : public ::sc_core::sc_module {
+ public:
+  explicit BenchmarkRunner(const ::sc_core::sc_module_name&) { SC_THREAD(Run); }
+
+ private:
+  void Run() {
+    benchmark::RunSpecifiedBenchmarks();
+    sc_stop();
+  }
+};
+
+}  // namespace
+
+int sc_main(int argc, char* argv[]) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  scp::init_logging(
+      scp::LogConfig().logLevel(scp::log::INFO).logAsync(false).printSimTime(false).logFileName("/dev/null"));
+  sc_core::sc_report_handler::set_actions(sc_core::SC_INFO, sc_core::SC_LOG);
+
+  PinCaptureFixture pin_capture;
+  pin_capture_fixture = &pin_capture;
+  BenchmarkRunner runner("benchmarks");
+  sc_start();
+  benchmark::Shutdown();
+  return 0;
+}
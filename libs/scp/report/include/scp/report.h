@@ -17,15 +17,21 @@
 #ifndef _SCP_REPORT_H_
 #define _SCP_REPORT_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <streambuf>
+#include <memory>
 #include <array>
 #include <numeric>
 #include <vector>
 #include <numeric>
 #include <functional>
+#include <utility>
 
 #ifdef __GNUG__
 #include <cstdlib>
@@ -56,6 +62,37 @@ const sc_core::sc_verbosity SC_UNSET = (sc_core::sc_verbosity)INT_MAX;
 // must be global for macro to work.
 static const char* _SCP_FMT_EMPTY_STR = "";
 
+//! numeric values of the scp::log levels, usable in preprocessor conditions
+#define SCP_LOG_LEVEL_NONE     0
+#define SCP_LOG_LEVEL_FATAL    1
+#define SCP_LOG_LEVEL_ERROR    2
+#define SCP_LOG_LEVEL_WARNING  3
+#define SCP_LOG_LEVEL_INFO     4
+#define SCP_LOG_LEVEL_DEBUG    5
+#define SCP_LOG_LEVEL_TRACE    6
+#define SCP_LOG_LEVEL_TRACEALL 7
+
+/**
+ * the most verbose level that is compiled in at all. Report macros above it
+ * expand to a constant false condition, so neither the verbosity check nor
+ * the streamed arguments generate any code. Errors and fatals are always
+ * compiled in. Defaults to everything, e.g. build with
+ * -DSCP_MIN_LOG_LEVEL=SCP_LOG_LEVEL_INFO to drop DEBUG, TRACE and TRACEALL.
+ */
+#ifndef SCP_MIN_LOG_LEVEL
+#define SCP_MIN_LOG_LEVEL SCP_LOG_LEVEL_TRACEALL
+#endif
+
+#define SCP_LOG_LEVEL_ACTIVE(lvl) (SCP_MIN_LOG_LEVEL >= SCP_LOG_LEVEL_##lvl)
+
+/**
+ * the number of message bytes an ScLogger holds without allocating. Longer
+ * messages spill into a heap buffer.
+ */
+#ifndef SCP_LOG_INLINE_SIZE
+#define SCP_LOG_INLINE_SIZE 512
+#endif
+
 /** \ingroup scp-report
  *  @{
  */
@@ -79,6 +116,9 @@ enum class log {
     TRACEALL,
     DBGTRACE = TRACEALL
 };
+static_assert(static_cast<int>(log::WARNING) == SCP_LOG_LEVEL_WARNING &&
+                  static_cast<int>(log::TRACEALL) == SCP_LOG_LEVEL_TRACEALL,
+              "SCP_LOG_LEVEL_* must match scp::log");
 
 /**
  * @fn log as_log(int)
@@ -147,6 +187,11 @@ void init_logging(log level = log::WARNING, unsigned type_field_width = 24,
  * @param print_time whether to print the system time stamp
  */
 void reinit_logging(log level = log::WARNING);
+namespace detail {
+//! incremented whenever log levels change, invalidates all cached levels
+extern std::atomic<unsigned> log_generation;
+} // namespace detail
+
 /**
  * @struct LogConfig
  * @brief the configuration class for the logging setup
@@ -165,8 +210,10 @@ struct LogConfig {
     std::string log_file_name{ "" };
     std::string log_filter_regex{ "" };
     bool log_async{ true };
+    bool log_deferred{ false };
     bool report_only_first_error{ false };
     int file_info_from{ sc_core::SC_INFO };
+    std::vector<std::pair<sc_core::sc_time, log>> level_schedule{};
 
     //! set the logging level
     LogConfig& logLevel(log);
@@ -193,10 +240,14 @@ struct LogConfig {
     LogConfig& logFilterRegex(const std::string&);
     //! enable/disable asynchronous output (write to file in separate thread
     LogConfig& logAsync(bool = true);
+    //! enable/disable deferred formatting of info reports on a logging thread
+    LogConfig& logDeferred(bool = true);
     //! disable the printing of the file name from this level upwards.
     LogConfig& fileInfoFrom(int);
     //! disable/enable the supression of all error messages after the first
     LogConfig& reportOnlyFirstError(bool = true);
+    //! switch to the given logging level when the simulation reaches time t
+    LogConfig& logLevelAt(sc_core::sc_time t, log);
 };
 
 /**
@@ -207,10 +258,15 @@ struct scp_logger_cache {
     sc_core::sc_verbosity level = sc_core::SC_UNSET;
     std::string type;
     std::vector<std::string> features;
+    //! the detail::log_generation level was resolved in
+    unsigned generation = 0;
 
     /**
      * @brief Initialize the verbosity cache and/or return the cached value.
      *
+     * The cached value is resolved again after the log levels changed (see
+     * set_logging_level()).
+     *
      * @return sc_core::sc_verbosity
      */
     sc_core::sc_verbosity get_log_verbosity_cached(const char*, const char*);
@@ -284,6 +340,77 @@ sc_core::sc_verbosity get_log_verbosity(char const* t);
 inline sc_core::sc_verbosity get_log_verbosity(std::string const& t) {
     return get_log_verbosity(t.c_str());
 }
+/**
+ * @fn void warm_log_verbosity(const std::vector<std::string>&)
+ * @brief resolve the verbosity of the given names ahead of time
+ *
+ * Fills the process wide cache used by get_log_verbosity(const char*), so the
+ * first report with one of these names does not pay for the CCI lookup. Like
+ * the lookup itself it must run on the SystemC thread.
+ *
+ * @param names the SystemC hierarchy scope names
+ */
+void warm_log_verbosity(const std::vector<std::string>& names);
+
+namespace detail {
+/**
+ * @fn uint64_t fnv1a(const char*)
+ * @brief FNV-1a hash of a feature name, usable in constant expressions
+ */
+constexpr uint64_t fnv1a(const char* str) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (; *str; ++str)
+        hash = (hash ^ static_cast<unsigned char>(*str)) * 0x100000001b3ULL;
+    return hash;
+}
+
+/**
+ * @struct call_site
+ * @brief verbosity cache of one SCP_ macro with a string literal feature
+ *
+ * Each such macro owns a static instance. Once resolved, a filtered report
+ * costs one compare of level. Resolved sites are linked into a list so that
+ * set_logging_level() and reinit_logging() can reset them to SC_UNSET.
+ */
+struct call_site {
+    std::atomic<sc_core::sc_verbosity> level{ sc_core::SC_UNSET };
+    std::atomic<bool> linked{ false };
+    call_site* next{ nullptr };
+};
+
+sc_core::sc_verbosity resolve_call_site(call_site& site, const char* name,
+                                        uint64_t hash);
+
+template <std::size_t N>
+inline sc_core::sc_verbosity site_verbosity(call_site& site,
+                                            const char (&name)[N]) {
+    return resolve_call_site(site, name, fnv1a(name));
+}
+// a writable array may change, so it is looked up like any other name
+template <std::size_t N>
+inline sc_core::sc_verbosity site_verbosity(call_site&, char (&name)[N]) {
+    return get_log_verbosity(name);
+}
+template <typename T>
+inline sc_core::sc_verbosity site_verbosity(call_site&, const T& name) {
+    return get_log_verbosity(name);
+}
+inline sc_core::sc_verbosity site_verbosity(call_site&) {
+    return get_log_verbosity();
+}
+
+//! the verbosity check of the string form, called with the macro arguments
+struct check_site {
+    call_site& site;
+    int lvl;
+
+    template <typename... T>
+    inline bool operator()(T&&... name) const {
+        return site.level.load(std::memory_order_relaxed) >= lvl &&
+               site_verbosity(site, std::forward<T>(name)...) >= lvl;
+    }
+};
+} // namespace detail
 
 /**
  * @brief Return list of logging parameters that have been used
@@ -291,6 +418,87 @@ inline sc_core::sc_verbosity get_log_verbosity(std::string const& t) {
  */
 std::vector<std::string> get_logging_parameters();
 
+namespace detail {
+/**
+ * @class log_streambuf
+ * @brief output stream buffer with inline storage
+ *
+ * Similar to fmt::basic_memory_buffer: the first N-1 characters are kept
+ * inside the object, only longer messages allocate.
+ *
+ * @tparam N the size of the inline storage
+ */
+template <std::size_t N>
+class log_streambuf : public std::streambuf
+{
+public:
+    log_streambuf() { setp(store, store + N - 1); }
+
+    log_streambuf(const log_streambuf&) = delete;
+
+    log_streambuf& operator=(const log_streambuf&) = delete;
+    /**
+     * @fn const char* c_str()
+     * @brief the null terminated message collected so far
+     *
+     * @return pointer to the message, valid until the next write
+     */
+    const char* c_str() {
+        *pptr() = '\0';
+        return pbase();
+    }
+    //! the length of the message collected so far
+    std::size_t size() const { return pptr() - pbase(); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof()))
+            return traits_type::not_eof(ch);
+        grow(1);
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        if (epptr() - pptr() < n)
+            grow(static_cast<std::size_t>(n));
+        std::memcpy(pptr(), s, static_cast<std::size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+private:
+    void grow(std::size_t extra) {
+        const std::size_t used = pptr() - pbase();
+        const std::size_t cap = std::max<std::size_t>(
+            2 * static_cast<std::size_t>(epptr() - pbase() + 1),
+            used + extra + 1);
+        std::unique_ptr<char[]> spill(new char[cap]);
+        std::memcpy(spill.get(), pbase(), used);
+        heap = std::move(spill);
+        setp(heap.get(), heap.get() + cap - 1);
+        pbump(static_cast<int>(used));
+    }
+
+    char store[N];
+    std::unique_ptr<char[]> heap;
+};
+
+//! set while LogConfig::log_deferred is in effect
+extern std::atomic<bool> deferred_logging;
+/**
+ * @fn void log_deferred(const char*, const char*, size_t, int, const char*,
+ * int)
+ * @brief queue an info report for formatting on the logging thread
+ *
+ * Records the message with the current simulation time and delta count in
+ * the calling thread's ring, bypassing sc_report_handler.
+ */
+void log_deferred(const char* type, const char* msg, std::size_t len,
+                  int verbosity, const char* file, int line);
+} // namespace detail
+
 /**
  * @struct ScLogger
  * @brief the logger class
@@ -328,8 +536,13 @@ struct ScLogger {
      *
      */
     virtual ~ScLogger() {
-        ::sc_core::sc_report_handler::report(
-            SEVERITY, t ? t : "SystemC", os.str().c_str(), level, file, line);
+        if (SEVERITY == sc_core::SC_INFO &&
+            detail::deferred_logging.load(std::memory_order_relaxed))
+            detail::log_deferred(t ? t : "SystemC", buf.c_str(), buf.size(),
+                                 level, file, line);
+        else
+            ::sc_core::sc_report_handler::report(
+                SEVERITY, t ? t : "SystemC", buf.c_str(), level, file, line);
     }
     /**
      * @fn ScLogger& type()
@@ -365,14 +578,15 @@ struct ScLogger {
     }
     /**
      * @fn std::ostream& get()
-     * @brief  get the underlying ostringstream
+     * @brief  get the underlying output stream
      *
      * @return the output stream collecting the log message
      */
     inline std::ostream& get() { return os; };
 
 protected:
-    std::ostringstream os{};
+    detail::log_streambuf<SCP_LOG_INLINE_SIZE> buf{};
+    std::ostream os{ &buf };
     char* t{ nullptr };
     const char* file;
     const int line;
@@ -461,13 +675,20 @@ public:
 // or a cache'd level
 
 /*** Helper macros for SCP_ report macros ****/
-#define SCP_VBSTY_CHECK_CACHED(lvl, features, cached, ...)             \
-    (cached.level >= lvl) &&                                           \
-        (cached.get_log_verbosity_cached(scp::call_sc_name_fn()(this), \
+#define SCP_VBSTY_CHECK_CACHED(lvl, features, cached, ...)                    \
+    (cached.level >= lvl ||                                                   \
+     cached.generation !=                                                     \
+         ::scp::detail::log_generation.load(std::memory_order_relaxed)) &&    \
+        (cached.get_log_verbosity_cached(scp::call_sc_name_fn()(this),        \
                                          typeid(*this).name()) >= lvl)
 
-#define SCP_VBSTY_CHECK_UNCACHED(lvl, ...) \
-    (::scp::get_log_verbosity(__VA_ARGS__) >= lvl)
+#define SCP_VBSTY_CHECK_UNCACHED(lvl, ...)             \
+    ::scp::detail::check_site{ []() -> ::scp::detail::call_site& { \
+                                  static ::scp::detail::call_site \
+                                      _scp_site;                  \
+                                  return _scp_site;               \
+                              }(),                                \
+                               lvl }(__VA_ARGS__)
 
 #define SCP_VBSTY_CHECK(lvl, ...)                                    \
     IIF(IS_PAREN(FIRST_ARG(__VA_ARGS__)))                            \
@@ -498,23 +719,28 @@ public:
 
 //! macro for debug trace level output
 #define SCP_TRACEALL(...)                                  \
-    if (SCP_VBSTY_CHECK(sc_core::SC_DEBUG, ##__VA_ARGS__)) \
+    if (SCP_LOG_LEVEL_ACTIVE(TRACEALL) &&                  \
+        SCP_VBSTY_CHECK(sc_core::SC_DEBUG, ##__VA_ARGS__)) \
     SCP_LOG(sc_core::SC_DEBUG, __VA_ARGS__)
 //! macro for trace level output
 #define SCP_TRACE(...)                                    \
-    if (SCP_VBSTY_CHECK(sc_core::SC_FULL, ##__VA_ARGS__)) \
+    if (SCP_LOG_LEVEL_ACTIVE(TRACE) &&                    \
+        SCP_VBSTY_CHECK(sc_core::SC_FULL, ##__VA_ARGS__)) \
     SCP_LOG(sc_core::SC_FULL, __VA_ARGS__)
 //! macro for debug level output
 #define SCP_DEBUG(...)                                    \
-    if (SCP_VBSTY_CHECK(sc_core::SC_HIGH, ##__VA_ARGS__)) \
+    if (SCP_LOG_LEVEL_ACTIVE(DEBUG) &&                    \
+        SCP_VBSTY_CHECK(sc_core::SC_HIGH, ##__VA_ARGS__)) \
     SCP_LOG(sc_core::SC_HIGH, __VA_ARGS__)
 //! macro for info level output
 #define SCP_INFO(...)                                       \
-    if (SCP_VBSTY_CHECK(sc_core::SC_MEDIUM, ##__VA_ARGS__)) \
+    if (SCP_LOG_LEVEL_ACTIVE(INFO) &&                       \
+        SCP_VBSTY_CHECK(sc_core::SC_MEDIUM, ##__VA_ARGS__)) \
     SCP_LOG(sc_core::SC_MEDIUM, __VA_ARGS__)
 //! macro for warning level output
 #define SCP_WARN(...)                                          \
-    if (SCP_VBSTY_CHECK(sc_core::SC_LOW, ##__VA_ARGS__))       \
+    if (SCP_LOG_LEVEL_ACTIVE(WARNING) &&                       \
+        SCP_VBSTY_CHECK(sc_core::SC_LOW, ##__VA_ARGS__))       \
     ::scp::ScLogger<::sc_core::SC_WARNING>(__FILE__, __LINE__, \
                                            sc_core::SC_MEDIUM) \
             .type(SCP_GET_FEATURES(__VA_ARGS__))               \
@@ -20,16 +20,24 @@
  *      Author: eyck@minres.com
  */
 
+#define SC_INCLUDE_DYNAMIC_PROCESSES
 #include <scp/report.h>
+#include "report_internal.h"
+#include <algorithm>
 #include <set>
 #include <map>
 #include <array>
+#include <cctype>
 #include <chrono>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <systemc>
 #ifdef HAS_CCI
 #include <cci_configuration>
 #endif
+#include <atomic>
 #include <mutex>
 #include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -52,32 +60,60 @@
 #endif
 
 namespace {
-// Making this thread_local could cause thread copies of the same cache
-// entries, but more likely naming will be thread local too, and this avoids
-// races in the unordered_map
+using scp::detail::join;
+using scp::detail::level_trie;
+using scp::detail::log_filter;
+using scp::detail::msg_buffer;
+using scp::detail::split;
 
-#ifdef DISABLE_REPORT_THREAD_LOCAL
-std::unordered_map<uint64_t, sc_core::sc_verbosity> lut;
-#else
-thread_local std::unordered_map<uint64_t, sc_core::sc_verbosity> lut;
-#endif
+scp::detail::verbosity_table lut;
 
 #ifdef HAS_CCI
 cci::cci_originator scp_global_originator("scp_reporting_global");
 #endif
 
-std::set<std::string> logging_parameters;
+//! the loggers resolved so far, expanded by get_logging_parameters()
+struct logging_scope {
+    std::string scname;
+    std::vector<std::string> features;
+    std::string type;
+
+    bool operator<(const logging_scope& o) const {
+        return std::tie(scname, features, type) <
+               std::tie(o.scname, o.features, o.type);
+    }
+};
+std::mutex logging_scopes_guard;
+std::set<logging_scope> logging_scopes;
 
 struct ExtLogConfig : public scp::LogConfig {
     std::shared_ptr<spdlog::logger> file_logger;
     std::shared_ptr<spdlog::logger> console_logger;
-    std::regex reg_ex;
+    log_filter filter;
     sc_core::sc_time cycle_base{ 0, sc_core::SC_NS };
     auto operator=(const scp::LogConfig& o) -> ExtLogConfig& {
         scp::LogConfig::operator=(o);
         return *this;
     }
-    auto match(const char* type) -> bool { return regex_search(type, reg_ex); }
+    void compile_filter() {
+        filter.compile(log_filter_regex);
+        matched.clear();
+    }
+    //! the filter result, remembered per message type
+    auto match(const char* type) const -> bool {
+        auto h = scp::detail::fnv1a(type);
+        auto it = matched.find(h);
+        if (likely(it != matched.end() && it->second.first == type))
+            return it->second.second;
+        auto m = filter(type);
+        if (it == matched.end() && matched.size() < 4096)
+            matched.emplace(h, std::make_pair(std::string(type), m));
+        return m;
+    }
+
+private:
+    // keyed by hash, the name is kept to tell collisions apart
+    mutable std::unordered_map<uint64_t, std::pair<std::string, bool>> matched;
 };
 
 /* normally put the config in thread local. If two threads try to use logging
@@ -90,33 +126,85 @@ ExtLogConfig log_cfg;
 thread_local ExtLogConfig log_cfg;
 #endif
 
-inline std::string padded(std::string str, size_t width,
+/**
+ * the fields of a report that end up in the log line. Filled from an
+ * sc_report when it is issued, or from a deferred record on the logging
+ * thread.
+ */
+struct log_entry {
+    sc_core::sc_severity severity;
+    int verbosity;
+    int id;
+    const char* msg_type;
+    const char* msg;
+    const char* file_name;
+    int line_number;
+    const char* process_name; // nullptr if not issued from a process
+    sc_core::sc_time::value_type time;
+    uint64_t delta;
+};
+
+auto make_entry(const sc_core::sc_report& rep) -> log_entry {
+    return { rep.get_severity(),
+             rep.get_verbosity(),
+             rep.get_id(),
+             rep.get_msg_type(),
+             rep.get_msg(),
+             rep.get_file_name(),
+             rep.get_line_number(),
+             sc_core::sc_get_curr_simcontext() && sc_core::sc_is_running()
+                 ? rep.get_process_name()
+                 : nullptr,
+             sc_core::sc_time_stamp().value(),
+             sc_core::sc_delta_count() };
+}
+
+#ifdef DISABLE_REPORT_THREAD_LOCAL
+msg_buffer msg_buf;
+#else
+thread_local msg_buffer msg_buf;
+#endif
+
+inline void append_padded(msg_buffer& buf, const char* str, size_t width,
                           bool show_ellipsis = true) {
-    if (width < 7)
-        return str;
-    if (str.length() > width) {
+    const auto len = std::strlen(str);
+    if (width < 7) {
+        buf.append(str, len);
+    } else if (len > width) {
         if (show_ellipsis) {
-            auto pos = str.size() - (width - 6);
-            return str.substr(0, 3) + "..." +
-                   str.substr(pos, str.size() - pos);
+            auto pos = len - (width - 6);
+            buf.append(str, 3);
+            buf.append("...", 3);
+            buf.append(str + pos, len - pos);
         } else
-            return str.substr(0, width);
+            buf.append(str, width);
     } else {
-        return str + std::string(width - str.size(), ' ');
+        buf.append(str, len);
+        buf.fill(' ', width - len);
     }
 }
 
-auto get_tuple(const sc_core::sc_time& t)
-    -> std::tuple<sc_core::sc_time::value_type, sc_core::sc_time_unit> {
-    auto val = t.value();
-    auto tr = (uint64_t)(sc_core::sc_time::from_value(1).to_seconds() * 1E15);
-    auto scale = 0U;
-    while ((tr % 10) == 0) {
-        tr /= 10;
-        scale++;
-    }
-    sc_assert(tr == 1);
+/* log10 of the time resolution in fs. Probed on the first non-zero time, when
+ * the resolution can no longer change, by the thread issuing the report (also
+ * in deferred mode, see log_deferred). */
+auto resolution_scale() -> unsigned {
+    static const unsigned scale = []() {
+        auto tr =
+            (uint64_t)(sc_core::sc_time::from_value(1).to_seconds() * 1E15);
+        auto s = 0U;
+        while ((tr % 10) == 0) {
+            tr /= 10;
+            s++;
+        }
+        sc_assert(tr == 1);
+        return s;
+    }();
+    return scale;
+}
 
+auto get_tuple(sc_core::sc_time::value_type val)
+    -> std::tuple<sc_core::sc_time::value_type, sc_core::sc_time_unit> {
+    auto scale = resolution_scale();
     auto tu = scale / 3;
     while (tu < sc_core::SC_SEC && (val % 10) == 0) {
         val /= 10;
@@ -127,8 +215,10 @@ auto get_tuple(const sc_core::sc_time& t)
         val *= 10;
     return std::make_tuple(val, static_cast<sc_core::sc_time_unit>(tu));
 }
+} // namespace
 
-auto time2string(const sc_core::sc_time& t) -> std::string {
+auto scp::detail::time2chars(char* out, sc_core::sc_time::value_type t)
+    -> size_t {
     const std::array<const char*, 6> time_units{ "fs", "ps", "ns",
                                                  "us", "ms", "s " };
     const std::array<uint64_t, 6> multiplier{ 1ULL,
@@ -138,100 +228,133 @@ auto time2string(const sc_core::sc_time& t) -> std::string {
                                               1000ULL * 1000 * 1000 * 1000,
                                               1000ULL * 1000 * 1000 * 1000 *
                                                   1000 };
-    std::ostringstream oss;
-    if (!t.value()) {
-        oss << "0 s ";
-    } else {
-        const auto tt = get_tuple(t);
-        const auto val = std::get<0>(tt);
-        const auto scale = std::get<1>(tt);
-        const auto fs_val = val * multiplier[scale];
-        for (int j = multiplier.size() - 1; j >= scale; --j) {
-            if (fs_val >= multiplier[j]) {
-                const auto i = val / multiplier[j - scale];
-                const auto f = val % multiplier[j - scale];
-                oss << i << '.' << std::setw(3 * (j - scale))
-                    << std::setfill('0') << std::right << f << ' '
-                    << time_units[j];
-                break;
-            }
+    if (!t) {
+        std::memcpy(out, "0 s ", 4);
+        return 4;
+    }
+    const auto tt = get_tuple(t);
+    const auto val = std::get<0>(tt);
+    const auto scale = std::get<1>(tt);
+    const auto fs_val = val * multiplier[scale];
+    for (int j = multiplier.size() - 1; j >= scale; --j) {
+        if (fs_val >= multiplier[j]) {
+            const auto i = val / multiplier[j - scale];
+            const auto f = val % multiplier[j - scale];
+            auto n = msg_buffer::format_uint(out, i);
+            out[n++] = '.';
+            char digits[20];
+            auto fn = msg_buffer::format_uint(digits, f);
+            for (auto w = 3U * (j - scale); fn < w; --w)
+                out[n++] = '0';
+            std::memcpy(out + n, digits, fn);
+            n += fn;
+            out[n++] = ' ';
+            std::memcpy(out + n, time_units[j], 2);
+            return n + 2;
         }
     }
-    return oss.str();
-}
-auto compose_message(const sc_core::sc_report& rep, const scp::LogConfig& cfg)
-    -> const std::string {
-    if (rep.get_severity() > sc_core::SC_INFO ||
-        cfg.log_filter_regex.length() == 0 ||
-        rep.get_verbosity() == sc_core::SC_MEDIUM ||
-        log_cfg.match(rep.get_msg_type())) {
-        std::stringstream os;
-        if (likely(cfg.print_sim_time)) {
-            if (unlikely(log_cfg.cycle_base.value())) {
-                if (unlikely(cfg.print_delta))
-                    os << "[" << std::setw(7) << std::setfill(' ')
-                       << sc_core::sc_time_stamp().value() /
-                              log_cfg.cycle_base.value()
-                       << "(" << std::setw(5) << sc_core::sc_delta_count()
-                       << ")]";
-                else
-                    os << "[" << std::setw(7) << std::setfill(' ')
-                       << sc_core::sc_time_stamp().value() /
-                              log_cfg.cycle_base.value()
-                       << "]";
-            } else {
-                auto t = time2string(sc_core::sc_time_stamp());
-                if (unlikely(cfg.print_delta))
-                    os << "[" << std::setw(20) << std::setfill(' ') << t << "("
-                       << std::setw(5) << sc_core::sc_delta_count() << ")]";
-                else
-                    os << "[" << std::setw(20) << std::setfill(' ') << t
-                       << "]";
+    return 0;
+}
+
+// reports come in bursts at the same time, so the text of the last time is
+// kept per thread
+void scp::detail::append_time(msg_buffer& buf,
+                              sc_core::sc_time::value_type t) {
+    struct formatted_time {
+        sc_core::sc_time::value_type value{
+            std::numeric_limits<sc_core::sc_time::value_type>::max()
+        };
+        size_t len{ 0 };
+        char text[48];
+    };
+#ifdef DISABLE_REPORT_THREAD_LOCAL
+    static formatted_time last;
+#else
+    thread_local formatted_time last;
+#endif
+    if (unlikely(t != last.value)) {
+        last.len = time2chars(last.text, t);
+        last.value = t;
+    }
+    if (last.len < 20)
+        buf.fill(' ', 20 - last.len);
+    buf.append(last.text, last.len);
+}
+
+namespace {
+
+/**
+ * composes the text of a report into buf. print_sim_time and
+ * type_field_width override the respective fields of cfg (the file logger
+ * always prints them). Returns false if the report is filtered out.
+ */
+auto compose_message(msg_buffer& buf, const log_entry& rep,
+                     const ExtLogConfig& cfg, bool print_sim_time,
+                     unsigned type_field_width) -> bool {
+    if (rep.severity > sc_core::SC_INFO || cfg.log_filter_regex.length() == 0 ||
+        rep.verbosity == sc_core::SC_MEDIUM || cfg.match(rep.msg_type)) {
+        buf.clear();
+        if (likely(print_sim_time)) {
+            buf.append('[');
+            if (unlikely(cfg.cycle_base.value()))
+                buf.append(rep.time / cfg.cycle_base.value(), 7);
+            else
+                scp::detail::append_time(buf, rep.time);
+            if (unlikely(cfg.print_delta)) {
+                buf.append('(');
+                buf.append(rep.delta, 5);
+                buf.append(')');
             }
+            buf.append(']');
         }
-        if (unlikely(rep.get_id() >= 0))
-            os << "("
-               << "IWEF"[rep.get_severity()] << rep.get_id() << ") "
-               << rep.get_msg_type() << ": ";
-        else if (cfg.msg_type_field_width) {
-            if (cfg.msg_type_field_width ==
-                std::numeric_limits<unsigned>::max())
-                os << rep.get_msg_type() << ": ";
+        if (unlikely(rep.id >= 0)) {
+            buf.append('(');
+            buf.append("IWEF"[rep.severity]);
+            buf.append(static_cast<uint64_t>(rep.id), 0);
+            buf.append(") ", 2);
+            buf.append(rep.msg_type);
+            buf.append(": ", 2);
+        } else if (type_field_width) {
+            if (type_field_width == std::numeric_limits<unsigned>::max())
+                buf.append(rep.msg_type);
             else
-                os << padded(rep.get_msg_type(), cfg.msg_type_field_width)
-                   << ": ";
+                append_padded(buf, rep.msg_type, type_field_width);
+            buf.append(": ", 2);
         }
-        if (*rep.get_msg())
-            os << rep.get_msg();
-        if (rep.get_severity() >= cfg.file_info_from) {
-            if (rep.get_line_number())
-                os << "\n         [FILE:" << rep.get_file_name() << ":"
-                   << rep.get_line_number() << "]";
-            sc_core::sc_simcontext* simc = sc_core::sc_get_curr_simcontext();
-            if (simc && sc_core::sc_is_running()) {
-                const char* proc_name = rep.get_process_name();
-                if (proc_name)
-                    os << "\n         [PROCESS:" << proc_name << "]";
+        if (*rep.msg)
+            buf.append(rep.msg);
+        if (rep.severity >= cfg.file_info_from) {
+            if (rep.line_number) {
+                buf.append("\n         [FILE:");
+                buf.append(rep.file_name);
+                buf.append(':');
+                buf.append(static_cast<uint64_t>(rep.line_number), 0);
+                buf.append(']');
+            }
+            if (rep.process_name) {
+                buf.append("\n         [PROCESS:");
+                buf.append(rep.process_name);
+                buf.append(']');
             }
         }
-        return os.str();
+        return true;
     } else
-        return "";
+        return false;
 }
 
-inline auto get_verbosity(const sc_core::sc_report& rep) -> int {
-    return rep.get_verbosity() > sc_core::SC_NONE &&
-                   rep.get_verbosity() < sc_core::SC_LOW
-               ? rep.get_verbosity() * 10
-               : rep.get_verbosity();
+inline auto get_verbosity(const log_entry& rep) -> int {
+    return rep.verbosity > sc_core::SC_NONE && rep.verbosity < sc_core::SC_LOW
+               ? rep.verbosity * 10
+               : rep.verbosity;
 }
 
-inline void log2logger(spdlog::logger& logger, const sc_core::sc_report& rep,
-                       const scp::LogConfig& cfg) {
-    auto msg = compose_message(rep, cfg);
-    if (!msg.size())
+inline void log2logger(spdlog::logger& logger, const log_entry& rep,
+                       const ExtLogConfig& cfg, bool print_sim_time,
+                       unsigned type_field_width) {
+    if (!compose_message(msg_buf, rep, cfg, print_sim_time, type_field_width))
         return;
-    switch (rep.get_severity()) {
+    const spdlog::string_view_t msg{ msg_buf.data(), msg_buf.size() };
+    switch (rep.severity) {
     case sc_core::SC_INFO:
         switch (get_verbosity(rep)) {
         case sc_core::SC_DEBUG:
@@ -287,25 +410,227 @@ inline void log2logger(spdlog::logger& logger, scp::log lvl,
     }
 }
 
+void write_entry(const log_entry& entry, sc_core::sc_actions actions,
+                 const ExtLogConfig& cfg) {
+    if ((actions & sc_core::SC_DISPLAY) &&
+        (!cfg.file_logger || get_verbosity(entry) < sc_core::SC_HIGH))
+        log2logger(*cfg.console_logger, entry, cfg, cfg.print_sim_time,
+                   cfg.msg_type_field_width);
+    if ((actions & sc_core::SC_LOG) && cfg.file_logger)
+        log2logger(*cfg.file_logger, entry, cfg, true,
+                   cfg.msg_type_field_width ? cfg.msg_type_field_width : 24);
+}
+
+/**
+ * single producer, single consumer ring of variable sized records. Every
+ * thread issuing deferred reports owns one, the logging thread drains them
+ * all. Records start with a record_hdr and are padded to 8 bytes; a record
+ * that would wrap is preceded by a skip record filling the end of the ring.
+ */
+class deferred_ring
+{
+public:
+    static constexpr size_t capacity = 1U << 20;
+
+    struct record_hdr {
+        uint32_t size; // including this header and padding
+        uint32_t skip; // non-zero for the filler before a wrap
+        sc_core::sc_time::value_type time;
+        uint64_t delta;
+        const char* file_name; // __FILE__ of the call site, never copied
+        int32_t line_number;
+        int32_t verbosity;
+        uint32_t type_len;
+        uint32_t msg_len;
+        uint32_t proc_len;
+        uint32_t reserved;
+        // followed by type, message and process name, each 0 terminated
+    };
+
+    deferred_ring(): data(new char[capacity]) {}
+
+    //! producer: space for n bytes (a multiple of 8), nullptr while full
+    auto try_reserve(size_t n) -> char* {
+        auto pos = head.load(std::memory_order_relaxed);
+        auto off = pos & (capacity - 1);
+        auto need = capacity - off < n ? capacity - off + n : n;
+        if (capacity - (pos - tail.load(std::memory_order_acquire)) < need)
+            return nullptr;
+        if (need != n) {
+            auto* filler = reinterpret_cast<uint32_t*>(data.get() + off);
+            filler[0] = static_cast<uint32_t>(capacity - off);
+            filler[1] = 1;
+            head.store(pos + capacity - off, std::memory_order_release);
+            off = 0;
+        }
+        return data.get() + off;
+    }
+    //! producer: publish the n bytes returned by the last try_reserve()
+    void commit(size_t n) {
+        head.store(head.load(std::memory_order_relaxed) + n,
+                   std::memory_order_release);
+    }
+    /* consumer: call f for every published record, returns the count. The
+     * logging thread and the owning thread (see deferred_logger::flush) both
+     * consume, serialized by deferred_logger::cfg_mtx. */
+    template <typename F>
+    auto drain(F&& f) -> size_t {
+        auto pos = tail.load(std::memory_order_relaxed);
+        auto end = head.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (pos != end) {
+            auto* hdr = reinterpret_cast<const record_hdr*>(
+                data.get() + (pos & (capacity - 1)));
+            if (!hdr->skip) {
+                f(*hdr);
+                ++count;
+            }
+            pos += hdr->size;
+        }
+        tail.store(pos, std::memory_order_release);
+        return count;
+    }
+    auto empty() const -> bool {
+        return tail.load(std::memory_order_acquire) ==
+               head.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    alignas(64) std::atomic<uint64_t> tail{ 0 };
+    std::unique_ptr<char[]> data;
+};
+
+/**
+ * the logging thread of the deferred mode. It formats the queued reports with
+ * a copy of the configuration that is refreshed whenever the configuring
+ * thread changes it, and drains everything that is left when the program
+ * exits. A thread that has to wait for its ring (it is full, or a synchronous
+ * report must not overtake it) drains the ring itself instead.
+ */
+class deferred_logger
+{
+public:
+    deferred_logger(): worker([this]() { run(); }) {}
+
+    ~deferred_logger() {
+        scp::detail::deferred_logging.store(false);
+        running.store(false);
+        worker.join();
+        drain_all();
+        std::lock_guard<std::mutex> lock(cfg_mtx);
+        cfg.console_logger->flush();
+        if (cfg.file_logger)
+            cfg.file_logger->flush();
+    }
+
+    void update(const ExtLogConfig& c) {
+        std::lock_guard<std::mutex> lock(cfg_mtx);
+        cfg = c;
+    }
+
+    //! the ring of the calling thread, registered on first use
+    auto ring() -> deferred_ring& {
+        if (unlikely(!own_ring)) {
+            auto r = std::make_shared<deferred_ring>();
+            std::lock_guard<std::mutex> lock(rings_mtx);
+            rings.push_back(r);
+            own_ring = r.get();
+        }
+        return *own_ring;
+    }
+
+    //! space for n bytes in the ring of the calling thread
+    auto reserve(size_t n) -> char* {
+        auto& r = ring();
+        auto* p = r.try_reserve(n);
+        while (unlikely(!p)) {
+            flush();
+            p = r.try_reserve(n);
+        }
+        return p;
+    }
+
+    //! write the queued reports of the calling thread
+    void flush() {
+        if (!own_ring || own_ring->empty())
+            return;
+        std::lock_guard<std::mutex> lock(cfg_mtx);
+        drain(*own_ring);
+    }
+
+private:
+    void run() {
+        while (running.load(std::memory_order_relaxed)) {
+            if (!drain_all())
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    auto drain_all() -> size_t {
+        std::vector<std::shared_ptr<deferred_ring>> current;
+        {
+            std::lock_guard<std::mutex> lock(rings_mtx);
+            current = rings;
+        }
+        std::lock_guard<std::mutex> lock(cfg_mtx);
+        size_t count = 0;
+        for (auto& r : current)
+            count += drain(*r);
+        return count;
+    }
+
+    // cfg_mtx must be held
+    auto drain(deferred_ring& r) -> size_t {
+        return r.drain([this](const deferred_ring::record_hdr& hdr) {
+            auto* type = reinterpret_cast<const char*>(&hdr + 1);
+            auto* msg = type + hdr.type_len + 1;
+            auto* proc = msg + hdr.msg_len + 1;
+            log_entry entry{ sc_core::SC_INFO,
+                             hdr.verbosity,
+                             -1,
+                             type,
+                             msg,
+                             hdr.file_name,
+                             hdr.line_number,
+                             hdr.proc_len ? proc : nullptr,
+                             hdr.time,
+                             hdr.delta };
+            write_entry(entry, sc_core::SC_LOG | sc_core::SC_DISPLAY, cfg);
+        });
+    }
+
+    std::mutex cfg_mtx;
+    ExtLogConfig cfg;
+    std::mutex rings_mtx;
+    std::vector<std::shared_ptr<deferred_ring>> rings;
+    std::atomic<bool> running{ true };
+    std::thread worker;
+    // rings stay registered after their thread exits, so this never dangles
+    static thread_local deferred_ring* own_ring;
+};
+thread_local deferred_ring* deferred_logger::own_ring = nullptr;
+
+/* created on first use after spdlog is initialized, so it is destroyed (and
+ * drains the rings) before the spdlog registry and its thread pool go away */
+auto get_deferred() -> deferred_logger& {
+    static deferred_logger instance;
+    return instance;
+}
+deferred_logger* deferred = nullptr;
+
 void report_handler(const sc_core::sc_report& rep,
                     const sc_core::sc_actions& actions) {
     thread_local bool sc_stop_called = false;
     if (actions & sc_core::SC_DO_NOTHING)
         return;
+    // keep the order with deferred reports issued before on this thread
+    if (scp::detail::deferred_logging.load(std::memory_order_relaxed))
+        deferred->flush();
     if (rep.get_severity() == sc_core::SC_INFO ||
         !log_cfg.report_only_first_error ||
-        sc_core::sc_report_handler::get_count(sc_core::SC_ERROR) < 2) {
-        if ((actions & sc_core::SC_DISPLAY) &&
-            (!log_cfg.file_logger || get_verbosity(rep) < sc_core::SC_HIGH))
-            log2logger(*log_cfg.console_logger, rep, log_cfg);
-        if ((actions & sc_core::SC_LOG) && log_cfg.file_logger) {
-            scp::LogConfig lcfg(log_cfg);
-            lcfg.print_sim_time = true;
-            if (!lcfg.msg_type_field_width)
-                lcfg.msg_type_field_width = 24;
-            log2logger(*log_cfg.file_logger, rep, lcfg);
-        }
-    }
+        sc_core::sc_report_handler::get_count(sc_core::SC_ERROR) < 2)
+        write_entry(make_entry(rep), actions, log_cfg);
     if (actions & sc_core::SC_STOP) {
         std::this_thread::sleep_for(std::chrono::milliseconds(
             static_cast<unsigned>(log_cfg.level) * 10));
@@ -331,15 +656,33 @@ void report_handler(const sc_core::sc_report& rep,
     }
 }
 
-// BKDR hash algorithm
-auto char_hash(char const* str) -> uint64_t {
-    constexpr unsigned int seed = 131; // 31  131 1313 13131131313 etc//
-    uint64_t hash = 0;
-    while (*str) {
-        hash = (hash * seed) + (*str);
-        str++;
-    }
-    return hash;
+// 0 is reserved for the empty slots of the verbosity table
+auto table_hash(uint64_t hash) -> uint64_t {
+    return hash ? hash : 1;
+}
+
+auto lookup_verbosity(char const* str, uint64_t hash)
+    -> sc_core::sc_verbosity {
+    hash = table_hash(hash);
+    sc_core::sc_verbosity v;
+    if (likely(lut.find(str, hash, v)))
+        return v;
+
+    scp::scp_logger_cache tmp;
+    v = tmp.get_log_verbosity_cached(str, "");
+    lut.insert(str, hash, v);
+    return v;
+}
+
+std::atomic<scp::detail::call_site*> call_sites{ nullptr };
+
+/* drops every cached verbosity of the string form. The generation is bumped
+ * before the sites are reset, see resolve_call_site for the other half. */
+void invalidate_verbosity_caches() {
+    lut.clear();
+    scp::detail::log_generation.fetch_add(1);
+    for (auto* site = call_sites.load(); site; site = site->next)
+        site->level.store(sc_core::SC_UNSET);
 }
 } // namespace
 
@@ -363,6 +706,65 @@ static const std::array<sc_core::sc_verbosity, 8> verbosity = {
     sc_core::SC_FULL,   // scp::log::TRACE
     sc_core::SC_DEBUG   // scp::log::TRACEALL
 };
+namespace {
+/* applies LogConfig::level_schedule, so a window of the simulation can be
+ * logged in more detail than the rest. The steps are taken from the
+ * SC_PRE_TIMESTEP stage instead of a process: a timed wait is activity of its
+ * own, and a step past the end would keep an unbounded sc_start() running
+ * until it. Nothing runs before the next activity, so every step up to it is
+ * applied as time is about to advance. A later configuration replaces the
+ * steps. */
+class level_schedule
+#if IEEE_1666_SYSTEMC >= 202301L
+    : public sc_core::sc_stage_callback_if
+#endif
+{
+public:
+    using steps_t = std::vector<std::pair<sc_core::sc_time, scp::log>>;
+
+    static void set(steps_t steps) {
+        std::stable_sort(steps.begin(), steps.end(),
+                         [](const std::pair<sc_core::sc_time, scp::log>& a,
+                            const std::pair<sc_core::sc_time, scp::log>& b) {
+                             return a.first < b.first;
+                         });
+        static level_schedule instance;
+        instance.steps = std::move(steps);
+        instance.next = 0;
+        instance.apply(sc_core::sc_time_stamp());
+        if (instance.next == instance.steps.size() || instance.registered)
+            return;
+#if IEEE_1666_SYSTEMC >= 202301L
+        sc_core::sc_register_stage_callback(instance,
+                                            sc_core::SC_PRE_TIMESTEP);
+        instance.registered = true;
+#else
+        SC_REPORT_WARNING("scp/report",
+                          "log level steps after the current time need "
+                          "SystemC stage callbacks and are ignored");
+#endif
+    }
+
+#if IEEE_1666_SYSTEMC >= 202301L
+    void stage_callback(const sc_core::sc_stage&) override {
+        if (sc_core::sc_pending_activity())
+            apply(sc_core::sc_time_stamp() +
+                  sc_core::sc_time_to_pending_activity());
+    }
+#endif
+
+private:
+    void apply(const sc_core::sc_time& upto) {
+        while (next < steps.size() && steps[next].first <= upto)
+            scp::set_logging_level(steps[next++].second);
+    }
+
+    steps_t steps;
+    size_t next{ 0 };
+    bool registered{ false };
+};
+} // namespace
+
 static std::mutex cfg_guard;
 static void configure_logging() {
     std::lock_guard<std::mutex> lock(cfg_guard);
@@ -376,6 +778,8 @@ static void configure_logging() {
     sc_core::sc_report_handler::set_verbosity_level(
         verbosity[static_cast<unsigned>(log_cfg.level)]);
     sc_core::sc_report_handler::set_handler(report_handler);
+    // a second configuration may come with another level
+    invalidate_verbosity_caches();
     if (!spdlog_initialized) {
         spdlog::init_thread_pool(
             1024U,
@@ -425,15 +829,71 @@ static void configure_logging() {
             log_cfg.file_logger = spdlog::get("file_logger");
     }
     if (log_cfg.log_filter_regex.size()) {
-        log_cfg.reg_ex = std::regex(log_cfg.log_filter_regex,
-                                    std::regex::extended | std::regex::icase);
+        log_cfg.compile_filter();
     }
+    level_schedule::set(log_cfg.level_schedule);
+    if (log_cfg.log_deferred && !deferred)
+        deferred = &get_deferred();
+    if (deferred)
+        deferred->update(log_cfg);
+    scp::detail::deferred_logging.store(log_cfg.log_deferred);
+}
+
+std::atomic<bool> scp::detail::deferred_logging{ false };
+
+void scp::detail::log_deferred(const char* type, const char* msg, size_t len,
+                               int verbosity, const char* file, int line) {
+    using hdr_t = deferred_ring::record_hdr;
+    const char* proc = nullptr;
+    if (log_cfg.file_info_from <= sc_core::SC_INFO &&
+        sc_core::sc_is_running()) {
+        auto h = sc_core::sc_get_current_process_handle();
+        if (h.valid())
+            proc = h.name();
+    }
+    // one record must never take more than a quarter of the ring
+    const size_t type_len = std::min<size_t>(std::strlen(type), 1024);
+    const size_t proc_len = proc ? std::min<size_t>(std::strlen(proc), 1024)
+                                 : 0;
+    const size_t msg_len = std::min<size_t>(
+        len, deferred_ring::capacity / 4 - sizeof(hdr_t) - 2048 - 3);
+    const size_t size =
+        (sizeof(hdr_t) + type_len + msg_len + proc_len + 3 + 7) & ~size_t(7);
+
+    const auto now = sc_core::sc_time_stamp().value();
+    // the logging thread must not be the one to probe the time resolution
+    if (now)
+        resolution_scale();
+
+    auto* p = deferred->reserve(size);
+    auto* hdr = reinterpret_cast<hdr_t*>(p);
+    hdr->size = static_cast<uint32_t>(size);
+    hdr->skip = 0;
+    hdr->time = now;
+    hdr->delta = sc_core::sc_delta_count();
+    hdr->file_name = file;
+    hdr->line_number = line;
+    hdr->verbosity = verbosity;
+    hdr->type_len = static_cast<uint32_t>(type_len);
+    hdr->msg_len = static_cast<uint32_t>(msg_len);
+    hdr->proc_len = static_cast<uint32_t>(proc_len);
+    auto* text = p + sizeof(hdr_t);
+    std::memcpy(text, type, type_len);
+    text[type_len] = '\0';
+    text += type_len + 1;
+    std::memcpy(text, msg, msg_len);
+    text[msg_len] = '\0';
+    text += msg_len + 1;
+    if (proc_len)
+        std::memcpy(text, proc, proc_len);
+    text[proc_len] = '\0';
+    deferred->ring().commit(size);
 }
 
 void scp::reinit_logging(scp::log level) {
     sc_core::sc_report_handler::set_handler(report_handler);
     log_cfg.level = level;
-    lut.clear();
+    invalidate_verbosity_caches();
 }
 
 void scp::init_logging(scp::log level, unsigned type_field_width,
@@ -453,6 +913,7 @@ void scp::set_logging_level(scp::log level) {
     log_cfg.level = level;
     sc_core::sc_report_handler::set_verbosity_level(
         verbosity[static_cast<unsigned>(level)]);
+    invalidate_verbosity_caches();
     log_cfg.console_logger->set_level(static_cast<spdlog::level::level_enum>(
         SPDLOG_LEVEL_OFF -
         std::min<int>(SPDLOG_LEVEL_OFF, static_cast<int>(log_cfg.level))));
@@ -464,6 +925,8 @@ auto scp::get_logging_level() -> scp::log {
 
 void scp::set_cycle_base(sc_core::sc_time period) {
     log_cfg.cycle_base = period;
+    if (deferred)
+        deferred->update(log_cfg);
 }
 
 auto scp::LogConfig::logLevel(scp::log level) -> scp::LogConfig& {
@@ -527,17 +990,28 @@ auto scp::LogConfig::logAsync(bool v) -> scp::LogConfig& {
     return *this;
 }
 
+auto scp::LogConfig::logDeferred(bool v) -> scp::LogConfig& {
+    this->log_deferred = v;
+    return *this;
+}
+
 auto scp::LogConfig::reportOnlyFirstError(bool v) -> scp::LogConfig& {
     this->report_only_first_error = v;
     return *this;
 }
 
+auto scp::LogConfig::logLevelAt(sc_core::sc_time t, scp::log level)
+    -> scp::LogConfig& {
+    this->level_schedule.emplace_back(t, level);
+    return *this;
+}
+
 auto scp::LogConfig::fileInfoFrom(int v) -> scp::LogConfig& {
     this->file_info_from = v;
     return *this;
 }
 
-std::vector<std::string> split(const std::string& s) {
+auto scp::detail::split(const std::string& s) -> std::vector<std::string> {
     std::vector<std::string> result;
     std::istringstream iss(s);
     std::string item;
@@ -547,7 +1021,7 @@ std::vector<std::string> split(const std::string& s) {
     return result;
 }
 
-std::string join(std::vector<std::string> vec) {
+auto scp::detail::join(std::vector<std::string> vec) -> std::string {
     if (vec.empty())
         return "";
     return std::accumulate(
@@ -557,9 +1031,35 @@ std::string join(std::vector<std::string> vec) {
         });
 }
 
+/* the parameter names that would set the level of a logger with these
+ * features and type, excluding the wildcard forms */
+void add_logging_parameters(std::set<std::string>& names,
+                            const logging_scope& scope) {
+    auto add = [&names](const std::string& s) {
+        names.insert(s + "." SCP_LOG_LEVEL_PARAM_NAME);
+    };
+    for (auto scn = split(scope.scname); scn.size(); scn.pop_back()) {
+        auto scn_str = join(scn);
+        for (auto& ft : scope.features)
+            for (auto ftn = split(ft); ftn.size(); ftn.pop_back())
+                add(scn_str + "." + join(ftn));
+        add(scn_str + "." + scope.type);
+        add(scn_str);
+    }
+    for (auto& ft : scope.features)
+        for (auto ftn = split(ft); ftn.size(); ftn.pop_back())
+            add(join(ftn));
+    add(scope.type);
+}
+
 std::vector<std::string> scp::get_logging_parameters() {
-    return std::vector<std::string>(logging_parameters.begin(),
-                                    logging_parameters.end());
+    std::set<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(logging_scopes_guard);
+        for (auto& scope : logging_scopes)
+            add_logging_parameters(names, scope);
+    }
+    return std::vector<std::string>(names.begin(), names.end());
 }
 
 #ifdef HAS_CCI
@@ -603,21 +1103,37 @@ std::string demangle(const char* name) {
 }
 #endif
 
-void insert(std::multimap<int, std::string, std::greater<int>>& map,
-            std::string s, bool interesting) {
-    int n = std::count(s.begin(), s.end(), '.');
-    map.insert(make_pair(n, s));
+#ifdef HAS_CCI
+/* one index per broker (see scp::detail::param_index). Parameters created
+ * between rebuilds are added as they appear. */
+struct broker_index {
+    scp::detail::param_index params;
+    cci::cci_param_create_callback_handle on_create;
+};
+std::mutex broker_indices_guard;
+std::map<std::string, broker_index> broker_indices;
 
-    if (interesting) {
-        logging_parameters.insert(s + "." SCP_LOG_LEVEL_PARAM_NAME);
+// broker_indices_guard must be held
+auto level_index(cci::cci_broker_handle& broker) -> const level_trie& {
+    auto& idx = broker_indices[broker.name()];
+    if (!idx.params.built) {
+        idx.on_create = broker.register_create_callback(
+            [&idx](const cci::cci_param_untyped_handle& h) {
+                std::lock_guard<std::mutex> lock(broker_indices_guard);
+                idx.params.trie.add(h.name());
+            });
     }
+    return idx.params.update(broker, scp::detail::log_generation.load());
 }
+#endif
 
 sc_core::sc_verbosity scp::scp_logger_cache::get_log_verbosity_cached(
     const char* scname, const char* tname = "") {
-    if (level != sc_core::SC_UNSET) {
+    auto gen = detail::log_generation.load();
+    if (level != sc_core::SC_UNSET && generation == gen) {
         return level;
     }
+    generation = gen;
 
     if (!scname && features.size())
         scname = features[0].c_str();
@@ -633,43 +1149,32 @@ sc_core::sc_verbosity scp::scp_logger_cache::get_log_verbosity_cached(
                           ? cci::cci_get_broker()
                           : cci::cci_get_global_broker(scp_global_originator);
 
-        std::multimap<int, std::string, std::greater<int>> allfeatures;
-
-        /* initialize */
-        for (auto scn = split(scname); scn.size(); scn.pop_back()) {
-            for (int first = 0; first < scn.size(); first++) {
-                auto f = scn.begin() + first;
-                std::vector<std::string> p(f, scn.end());
-                auto scn_str = ((first > 0) ? "*." : "") + join(p);
-
-                for (auto ft : features) {
-                    for (auto ftn = split(ft); ftn.size(); ftn.pop_back()) {
-                        insert(allfeatures, scn_str + "." + join(ftn),
-                               first == 0);
-                    }
-                }
-                insert(allfeatures, scn_str + "." + demangle(tname),
-                       first == 0);
-                insert(allfeatures, scn_str, first == 0);
-            }
-        }
-        for (auto ft : features) {
-            for (auto ftn = split(ft); ftn.size(); ftn.pop_back()) {
-                insert(allfeatures, join(ftn), true);
-                insert(allfeatures, "*." + join(ftn), false);
-            }
+        auto type_name = demangle(tname);
+        {
+            std::lock_guard<std::mutex> lock(logging_scopes_guard);
+            logging_scopes.insert({ scname, features, type_name });
         }
-        insert(allfeatures, demangle(tname), true);
-        insert(allfeatures, "*", false);
-        insert(allfeatures, "", false);
-
-        for (std::pair<int, std::string> f : allfeatures) {
-            sc_core::sc_verbosity v = cci_lookup(broker, f.second);
-            if (v != sc_core::SC_UNSET) {
-                level = v;
-                return v;
-            }
+
+        std::vector<std::vector<std::string>> feature_path;
+        for (auto& ft : features)
+            feature_path.push_back(split(ft));
+        // split() drops a trailing empty component, an empty type is one
+        auto type_path = type_name.empty() ? std::vector<std::string>{ "" }
+                                           : split(type_name);
+
+        std::vector<std::string> candidates;
+        {
+            std::lock_guard<std::mutex> lock(broker_indices_guard);
+            candidates = level_index(broker).resolve(split(scname),
+                                                     feature_path, type_path);
         }
+        auto v = scp::detail::first_level(
+            candidates,
+            [&broker](const std::string& name) {
+                return cci_lookup(broker, name);
+            });
+        if (v != sc_core::SC_UNSET)
+            return level = v;
     } catch (const std::exception&) {
         // If there is no global broker, revert to initialized verbosity level
     }
@@ -681,12 +1186,28 @@ sc_core::sc_verbosity scp::scp_logger_cache::get_log_verbosity_cached(
 }
 
 auto scp::get_log_verbosity(char const* str) -> sc_core::sc_verbosity {
-    auto k = char_hash(str);
-    auto it = lut.find(k);
-    if (it != lut.end())
-        return it->second;
+    return lookup_verbosity(str, scp::detail::fnv1a(str));
+}
 
-    scp::scp_logger_cache tmp;
-    lut[k] = tmp.get_log_verbosity_cached(str);
-    return lut[k];
+std::atomic<unsigned> scp::detail::log_generation{ 0 };
+
+auto scp::detail::resolve_call_site(call_site& site, const char* name,
+                                    uint64_t hash) -> sc_core::sc_verbosity {
+    auto gen = log_generation.load();
+    auto v = lookup_verbosity(name, hash);
+    if (!site.linked.exchange(true)) {
+        site.next = call_sites.load();
+        while (!call_sites.compare_exchange_weak(site.next, &site))
+            ;
+    }
+    site.level.store(v);
+    // an invalidation that ran since the lookup may have missed this store
+    if (log_generation.load() != gen)
+        site.level.store(sc_core::SC_UNSET);
+    return v;
+}
+
+void scp::warm_log_verbosity(const std::vector<std::string>& names) {
+    for (auto& name : names)
+        get_log_verbosity(name.c_str());
 }
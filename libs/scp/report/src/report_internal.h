@@ -0,0 +1,581 @@
+/*******************************************************************************
+ * Copyright 2017-2022 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * report_internal.h
+ *
+ * the building blocks of report.cpp, kept apart so they can be tested on
+ * their own. Not part of the installed interface.
+ */
+
+#ifndef _SCP_REPORT_INTERNAL_H_
+#define _SCP_REPORT_INTERNAL_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <scp/report.h>
+#include <string>
+#include <systemc>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifndef SCP_VERBOSITY_TABLE_SIZE
+#define SCP_VERBOSITY_TABLE_SIZE 8192
+#endif
+
+namespace scp {
+namespace detail {
+/**
+ * process wide cache of the verbosity of the names used with the string form
+ * of the SCP_ macros. Open addressing over the 64 bit hash of the name; a
+ * lookup reads one 32 byte slot and never locks, inserts are serialized. Each
+ * slot keeps an interned copy of its name, so a hash collision falls back to
+ * comparing the full key instead of returning another name's level. The
+ * pointer the entry was created with skips that compare for the same string.
+ *
+ * The table starts with SCP_VERBOSITY_TABLE_SIZE slots and doubles when it is
+ * 3/4 full. A grown table is filled before it is published, the old one is
+ * kept since readers may still probe it.
+ */
+class verbosity_table
+{
+public:
+    static constexpr size_t initial_capacity = SCP_VERBOSITY_TABLE_SIZE;
+    static_assert((initial_capacity & (initial_capacity - 1)) == 0,
+                  "SCP_VERBOSITY_TABLE_SIZE must be a power of two");
+
+    verbosity_table() {
+        tables.emplace_back(new table_t(initial_capacity));
+        current.store(tables.back().get(), std::memory_order_release);
+    }
+
+    auto find(const char* str, uint64_t hash, sc_core::sc_verbosity& v) const
+        -> bool {
+        const auto* t = current.load(std::memory_order_acquire);
+        for (auto i = hash & t->mask;; i = (i + 1) & t->mask) {
+            auto& slot = t->slots[i];
+            auto h = slot.hash.load(std::memory_order_acquire);
+            if (!h)
+                return false;
+            if (h == hash &&
+                (slot.ptr.load(std::memory_order_relaxed) == str ||
+                 !std::strcmp(slot.key.load(std::memory_order_relaxed), str))) {
+                v = slot.level.load(std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    void insert(const char* str, uint64_t hash, sc_core::sc_verbosity v) {
+        std::lock_guard<std::mutex> lock(guard);
+        auto* t = current.load(std::memory_order_relaxed);
+        auto i = probe(*t, str, hash);
+        auto& slot = t->slots[i];
+        if (slot.hash.load(std::memory_order_relaxed)) {
+            slot.level.store(v, std::memory_order_relaxed);
+            return;
+        }
+        // keep enough holes to end every probe sequence
+        if (used + 1 > (t->mask + 1) / 4 * 3) {
+            t = grow();
+            i = probe(*t, str, hash);
+        }
+        fill(t->slots[i], hash, str, names.insert(str).first->c_str(), v);
+        ++used;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(guard);
+        auto* t = current.load(std::memory_order_relaxed);
+        for (size_t i = 0; i <= t->mask; ++i)
+            t->slots[i].hash.store(0, std::memory_order_relaxed);
+        used = 0;
+    }
+
+    auto size() const -> size_t {
+        std::lock_guard<std::mutex> lock(guard);
+        return used;
+    }
+
+    auto capacity() const -> size_t {
+        return current.load(std::memory_order_acquire)->mask + 1;
+    }
+
+private:
+    struct alignas(32) slot_t {
+        std::atomic<uint64_t> hash{ 0 }; // 0 marks an empty slot
+        std::atomic<const char*> ptr{ nullptr };
+        std::atomic<const char*> key{ nullptr };
+        std::atomic<sc_core::sc_verbosity> level{ sc_core::SC_UNSET };
+    };
+    static_assert(std::is_trivially_destructible<slot_t>::value,
+                  "slots are never destroyed");
+    // operator new only guarantees the alignment of slot_t from C++17 on
+    struct table_t {
+        explicit table_t(size_t n)
+        : mask(n - 1), raw(new char[(n + 1) * sizeof(slot_t)]) {
+            auto addr = reinterpret_cast<uintptr_t>(raw.get());
+            auto* p = reinterpret_cast<char*>((addr + alignof(slot_t) - 1) &
+                                              ~uintptr_t(alignof(slot_t) - 1));
+            slots = reinterpret_cast<slot_t*>(p);
+            for (size_t i = 0; i < n; ++i)
+                new (p + i * sizeof(slot_t)) slot_t;
+        }
+        size_t mask;
+        std::unique_ptr<char[]> raw;
+        slot_t* slots;
+    };
+
+    // the slot holding str, or the empty slot ending its probe sequence
+    static auto probe(const table_t& t, const char* str, uint64_t hash)
+        -> size_t {
+        for (auto i = hash & t.mask;; i = (i + 1) & t.mask) {
+            auto& slot = t.slots[i];
+            auto h = slot.hash.load(std::memory_order_relaxed);
+            if (!h || (h == hash && !std::strcmp(slot.key.load(), str)))
+                return i;
+        }
+    }
+
+    static void fill(slot_t& slot, uint64_t hash, const char* ptr,
+                     const char* key, sc_core::sc_verbosity v) {
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.ptr.store(ptr, std::memory_order_relaxed);
+        slot.level.store(v, std::memory_order_relaxed);
+        slot.hash.store(hash, std::memory_order_release);
+    }
+
+    // guard must be held
+    auto grow() -> table_t* {
+        const auto* old = current.load(std::memory_order_relaxed);
+        tables.emplace_back(new table_t(2 * (old->mask + 1)));
+        auto* t = tables.back().get();
+        for (size_t i = 0; i <= old->mask; ++i) {
+            auto& slot = old->slots[i];
+            auto h = slot.hash.load(std::memory_order_relaxed);
+            if (!h)
+                continue;
+            auto key = slot.key.load(std::memory_order_relaxed);
+            fill(t->slots[probe(*t, key, h)], h,
+                 slot.ptr.load(std::memory_order_relaxed), key,
+                 slot.level.load(std::memory_order_relaxed));
+        }
+        current.store(t, std::memory_order_release);
+        return t;
+    }
+
+    std::atomic<table_t*> current{ nullptr };
+    mutable std::mutex guard;
+    size_t used{ 0 };
+    // never shrink, readers may still probe an old table or hold a key of a
+    // cleared slot
+    std::vector<std::unique_ptr<table_t>> tables;
+    std::unordered_set<std::string> names;
+};
+
+/**
+ * the log filter, a case insensitive extended regular expression searched in
+ * the message type. Alternatives made of plain characters, optionally
+ * anchored with ^ and $, are matched as literals; anything else falls back to
+ * std::regex.
+ */
+class log_filter
+{
+public:
+    void compile(const std::string& expr) {
+        literals.clear();
+        use_regex = !parse_literals(expr);
+        if (use_regex)
+            reg_ex = std::regex(expr, std::regex::extended | std::regex::icase);
+        else
+            reg_ex = std::regex();
+    }
+
+    auto operator()(const char* type) const -> bool {
+        if (use_regex)
+            return regex_search(type, reg_ex);
+        const auto len = std::strlen(type);
+        for (auto& l : literals)
+            if (l.find_in(type, len))
+                return true;
+        return false;
+    }
+
+private:
+    struct literal {
+        std::string text; // lower case
+        bool at_start;
+        bool at_end;
+
+        auto equal_at(const char* s) const -> bool {
+            for (size_t i = 0; i < text.size(); ++i)
+                if (lower(s[i]) != text[i])
+                    return false;
+            return true;
+        }
+        auto find_in(const char* s, size_t len) const -> bool {
+            if (text.size() > len)
+                return false;
+            if (at_start || at_end)
+                return (!at_start || !at_end || len == text.size()) &&
+                       equal_at(at_start ? s : s + len - text.size());
+            for (size_t pos = 0; pos + text.size() <= len; ++pos)
+                if (equal_at(s + pos))
+                    return true;
+            return false;
+        }
+    };
+
+    static auto lower(char c) -> char {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    // false if expr uses more than alternation, anchors and escapes
+    auto parse_literals(const std::string& expr) -> bool {
+        static const std::string special = ".[]()*+?{}^$\\|";
+        literal l{ "", false, false };
+        for (size_t i = 0; i <= expr.size(); ++i) {
+            if (i == expr.size() || expr[i] == '|') {
+                literals.push_back(l);
+                l = { "", false, false };
+            } else if (l.at_end) {
+                return false;
+            } else if (expr[i] == '^' && (i == 0 || expr[i - 1] == '|')) {
+                l.at_start = true;
+            } else if (expr[i] == '$' &&
+                       (i + 1 == expr.size() || expr[i + 1] == '|')) {
+                l.at_end = true;
+            } else if (expr[i] == '\\' && i + 1 < expr.size() &&
+                       special.find(expr[i + 1]) != std::string::npos) {
+                l.text += lower(expr[++i]);
+            } else if (special.find(expr[i]) != std::string::npos) {
+                return false;
+            } else
+                l.text += lower(expr[i]);
+        }
+        return true;
+    }
+
+    bool use_regex{ false };
+    std::vector<literal> literals;
+    std::regex reg_ex;
+};
+
+/**
+ * growable character buffer with inline storage. One instance per thread is
+ * reused for every message, so composing a log line does not allocate unless
+ * it is longer than the inline storage (and then only until the spill buffer
+ * is large enough).
+ */
+class msg_buffer
+{
+public:
+    msg_buffer() = default;
+    msg_buffer(const msg_buffer&) = delete;
+    msg_buffer& operator=(const msg_buffer&) = delete;
+
+    void clear() { len = 0; }
+    auto size() const -> size_t { return len; }
+    auto data() const -> const char* { return ptr; }
+
+    void append(const char* s, size_t n) {
+        reserve(len + n);
+        std::memcpy(ptr + len, s, n);
+        len += n;
+    }
+    void append(const char* s) { append(s, std::strlen(s)); }
+    void append(char c) {
+        reserve(len + 1);
+        ptr[len++] = c;
+    }
+    void fill(char c, size_t n) {
+        reserve(len + n);
+        std::memset(ptr + len, c, n);
+        len += n;
+    }
+    //! append v right aligned in a field of at least width characters
+    void append(uint64_t v, size_t width, char pad = ' ') {
+        char tmp[20];
+        auto n = format_uint(tmp, v);
+        if (n < width)
+            fill(pad, width - n);
+        append(tmp, n);
+    }
+    //! write the decimal digits of v to out, returns the number of digits
+    static auto format_uint(char* out, uint64_t v) -> size_t {
+        char tmp[20];
+        size_t n = 0;
+        do {
+            tmp[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = tmp[n - 1 - i];
+        return n;
+    }
+
+private:
+    void reserve(size_t n) {
+        if (n <= cap)
+            return;
+        cap = std::max(2 * cap, n);
+        std::unique_ptr<char[]> spill(new char[cap]);
+        std::memcpy(spill.get(), ptr, len);
+        heap = std::move(spill);
+        ptr = heap.get();
+    }
+
+    std::array<char, 1024> store;
+    std::unique_ptr<char[]> heap;
+    char* ptr{ store.data() };
+    size_t cap{ store.size() };
+    size_t len{ 0 };
+};
+
+/**
+ * writes the time (in units of the time resolution) in the largest unit not
+ * exceeding it, e.g. "1.500 us", to out which must hold at least 48
+ * characters. Returns the length.
+ */
+auto time2chars(char* out, sc_core::sc_time::value_type t) -> size_t;
+
+//! appends the text of time2chars() right aligned in 20 characters
+void append_time(msg_buffer& buf, sc_core::sc_time::value_type t);
+
+//! the dot separated components of s
+auto split(const std::string& s) -> std::vector<std::string>;
+
+//! the components joined with dots, the inverse of split()
+auto join(std::vector<std::string> vec) -> std::string;
+
+/**
+ * the log_level parameter names known to a broker, as a tree of their dot
+ * separated components. "log_level" itself marks the root, a leading "*" is
+ * an ordinary child of it.
+ *
+ * resolve() returns the names that apply to a logger in the order the
+ * candidates used to be tried: the name with the most components first, ties
+ * broken by hierarchy depth, then by the position of the first component
+ * (full names before wildcards), then by feature order. Instead of building
+ * and looking up every candidate, it walks the module name once from the
+ * root and once from the "*" node per start position, stopping as soon as a
+ * component is not in the tree.
+ */
+class level_trie
+{
+public:
+    struct node {
+        std::unordered_map<std::string, std::unique_ptr<node>> children;
+        bool is_param{ false };
+
+        auto child(const std::string& name) const -> const node* {
+            auto it = children.find(name);
+            return it == children.end() ? nullptr : it->second.get();
+        }
+    };
+
+    void clear() {
+        root.children.clear();
+        root.is_param = false;
+    }
+
+    void add(const std::string& param_name) {
+        static const std::string suffix = "." SCP_LOG_LEVEL_PARAM_NAME;
+        node* n = &root;
+        if (param_name != SCP_LOG_LEVEL_PARAM_NAME) {
+            if (param_name.size() <= suffix.size() ||
+                param_name.compare(param_name.size() - suffix.size(),
+                                   suffix.size(), suffix))
+                return;
+            for (auto& c : split(param_name.substr(
+                     0, param_name.size() - suffix.size()))) {
+                auto& next = n->children[c];
+                if (!next)
+                    next.reset(new node);
+                n = next.get();
+            }
+        }
+        n->is_param = true;
+    }
+
+    auto resolve(const std::vector<std::string>& scn,
+                 const std::vector<std::vector<std::string>>& features,
+                 const std::vector<std::string>& type) const
+        -> std::vector<std::string> {
+        std::vector<match> found;
+        const auto* star = root.child("*");
+        size_t feature_subs = 0;
+        for (auto& fc : features)
+            feature_subs += fc.size();
+
+        for (size_t first = 0; first < scn.size(); ++first) {
+            const node* n = first ? star : &root;
+            for (size_t len = first + 1; n && len <= scn.size(); ++len) {
+                n = n->child(scn[len - 1]);
+                if (!n)
+                    break;
+                const size_t base = len - first + (first ? 1 : 0);
+                auto name = [&](const std::vector<std::string>& tail,
+                                size_t k) {
+                    std::string s = first ? "*" : "";
+                    for (auto i = first; i < len; ++i)
+                        s += (s.empty() ? "" : ".") + scn[i];
+                    for (size_t i = 0; i < k; ++i)
+                        s += "." + tail[i];
+                    return s;
+                };
+                size_t off = 0;
+                for (auto& fc : features) {
+                    const node* m = n;
+                    for (size_t k = 1; k <= fc.size(); ++k) {
+                        m = m->child(fc[k - 1]);
+                        if (!m)
+                            break;
+                        if (m->is_param)
+                            found.push_back({ base + k, 0, len, first,
+                                              off + fc.size() - k,
+                                              name(fc, k) });
+                    }
+                    off += fc.size();
+                }
+                if (const node* m = walk(n, type))
+                    if (m->is_param)
+                        found.push_back({ base + type.size(), 0, len, first,
+                                          feature_subs,
+                                          name(type, type.size()) });
+                if (n->is_param)
+                    found.push_back(
+                        { base, 0, len, first, feature_subs + 1, name({}, 0) });
+            }
+        }
+
+        size_t off = 0;
+        for (auto& fc : features) {
+            const node* m = &root;
+            const node* w = star;
+            std::string s;
+            for (size_t k = 1; k <= fc.size() && (m || w); ++k) {
+                s += (k > 1 ? "." : "") + fc[k - 1];
+                const auto sub = 2 * (off + fc.size() - k);
+                if (m && (m = m->child(fc[k - 1])) && m->is_param)
+                    found.push_back({ k, 1, 0, 0, sub, s });
+                if (w && (w = w->child(fc[k - 1])) && w->is_param)
+                    found.push_back({ k + 1, 1, 0, 0, sub + 1, "*." + s });
+            }
+            off += fc.size();
+        }
+        // an empty type name on its own stands for "log_level"
+        const bool no_type = type.size() == 1 && type[0].empty();
+        if (const node* m = no_type ? &root : walk(&root, type))
+            if (m->is_param)
+                found.push_back({ no_type ? 1 : type.size(), 1, 0, 0,
+                                  2 * feature_subs, join(type) });
+        if (star && star->is_param)
+            found.push_back({ 1, 1, 0, 0, 2 * feature_subs + 1, "*" });
+        if (root.is_param)
+            found.push_back({ 1, 1, 0, 0, 2 * feature_subs + 2, "" });
+
+        std::sort(found.begin(), found.end());
+        std::vector<std::string> names;
+        for (auto& f : found)
+            names.push_back(std::move(f.name));
+        return names;
+    }
+
+private:
+    struct match {
+        size_t components; // one more than the dots in the candidate name
+        size_t tier;       // 0 below the module, 1 global features and type
+        size_t len;        // module name components used
+        size_t first;      // first module name component used
+        size_t sub;        // feature, type or module itself
+        std::string name;
+
+        bool operator<(const match& o) const {
+            return std::make_tuple(o.components, tier, o.len, first, sub) <
+                   std::make_tuple(components, o.tier, len, o.first, o.sub);
+        }
+    };
+
+    static auto walk(const node* n, const std::vector<std::string>& path)
+        -> const node* {
+        for (auto& c : path)
+            if (!(n = n->child(c)))
+                break;
+        return n;
+    }
+
+    node root;
+};
+
+/**
+ * the log level names one broker knows about. The trie is rebuilt from the
+ * broker's parameters when first used and when the generation changes, a
+ * parameter created in between is add()ed by the caller. Presets can be set
+ * at any time without any notification, so every update() adds the ones that
+ * are unconsumed so far.
+ *
+ * Broker provides get_param_handles(), items with a name(), and
+ * get_unconsumed_preset_values(), pairs of name and value.
+ */
+struct param_index {
+    level_trie trie;
+    bool built{ false };
+    unsigned generation{ 0 };
+
+    template <typename Broker>
+    auto update(Broker& broker, unsigned gen) -> const level_trie& {
+        if (!built || generation != gen) {
+            trie.clear();
+            for (auto& h : broker.get_param_handles())
+                trie.add(h.name());
+            built = true;
+            generation = gen;
+        }
+        for (auto& p : broker.get_unconsumed_preset_values())
+            trie.add(p.first);
+        return trie;
+    }
+};
+
+/**
+ * the level of the first of the candidates that has one. lookup returns
+ * SC_UNSET for a name that is not set, or not set to an int, so the next
+ * candidate is tried.
+ */
+template <typename Lookup>
+auto first_level(const std::vector<std::string>& candidates, Lookup lookup)
+    -> sc_core::sc_verbosity {
+    for (auto& name : candidates) {
+        sc_core::sc_verbosity v = lookup(name);
+        if (v != sc_core::SC_UNSET)
+            return v;
+    }
+    return sc_core::SC_UNSET;
+}
+} // namespace detail
+} // namespace scp
+
+#endif /* _SCP_REPORT_INTERNAL_H_ */
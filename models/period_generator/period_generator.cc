@@ -0,0 +1,98 @@
+#include "period_generator.h"
+
+#include <algorithm>
+
+#include "libs/scp/report/include/scp/report.h"
+
+period_generator::PatternGenerator::PatternGenerator(const Pattern& pattern) : repeat_(pattern.repeat) {
+  segments_.reserve(pattern.segments.size());
+  for (const auto& segment : pattern.segments) {
+    if (!segment.cycles) continue;
+    CompiledSegment compiled = {segment, 0};
+    if (segment.period >= pattern.periods.size())
+      SCP_ERR() << "Segment refers to period " << segment.period << " but only " << pattern.periods.size()
+                << " periods are defined";
+    else if (pattern.periods[segment.period].residue > Transaction::kMaxResidue)
+      SCP_ERR() << "Residue " << pattern.periods[segment.period].residue << " of period " << segment.period
+                << " does not fit in " << Transaction::kResidueBits << " bits";
+    else
+      compiled.residue = pattern.periods[segment.period].residue;
+    compiled.segment.type_sequence_len = std::min<uint32_t>(std::max<uint32_t>(segment.type_sequence_len, 1), 64);
+    segments_.push_back(compiled);
+  }
+  if (segments_.empty()) repeat_ = 0;
+
+  // boc_count is 32 bits wide and must not wrap, the end of pattern marker included
+  const uint64_t max_bocs = uint64_t{1} << 32;
+  uint64_t pass_bocs = 0;
+  bool runs = false;
+  for (const auto& compiled : segments_) {
+    pass_bocs = std::min(pass_bocs + std::min(compiled.segment.cycles, max_bocs), max_bocs);
+    runs |= compiled.segment.region != Segment::kHalted;
+  }
+  if (repeat_ && pass_bocs > (max_bocs - 1) / repeat_) {
+    SCP_ERR() << "Pattern of " << pass_bocs << " BOCs repeated " << repeat_ << " times overflows the "
+              << max_bocs << " values of the BOC count";
+    repeat_ = 0;
+  } else if (repeat_ && !runs) {
+    SCP_WARN() << "Pattern has no running BOC, reference models keep waiting for one";
+  }
+}
+
+size_t period_generator::PatternGenerator::Generate(Transaction* out, size_t max) {
+  size_t n = 0;
+  while (n < max && pass_ < repeat_) {
+    const CompiledSegment& current = segments_[segment_];
+    const Segment& segment = current.segment;
+    const uint64_t count = std::min<uint64_t>(max - n, segment.cycles - cycle_);
+
+    Transaction boc = {};
+    boc.is_halted = segment.region == Segment::kHalted;
+    boc.is_running = segment.region != Segment::kHalted;
+    boc.in_KA = segment.region == Segment::kKeepAlive;
+    boc.residue = current.residue;
+    for (uint64_t i = 0; i < count; ++i) {
+      boc.boc_count = boc_count_++;
+      boc.type = ((segment.type_sequence >> ((cycle_ + i) % segment.type_sequence_len)) & 1) ? Transaction::BOC_B
+                                                                                              : Transaction::BOC_A;
+      out[n++] = boc;
+    }
+
+    cycle_ += count;
+    if (cycle_ == segment.cycles) {
+      cycle_ = 0;
+      if (++segment_ == segments_.size()) {
+        segment_ = 0;
+        ++pass_;
+      }
+    }
+  }
+
+  // End of pattern marker
+  if (n < max && pass_ >= repeat_ && !done_) {
+    Transaction boc = {};
+    boc.boc_count = boc_count_++;
+    boc.is_halted = true;
+    out[n++] = boc;
+    done_ = true;
+  }
+  return n;
+}
+
+period_generator::ReferenceSystemCAgent::ReferenceSystemCAgent(const ::sc_core::sc_module_name&,
+                                                               const Pattern& pattern,
+                                                               yarn::ChannelPut<Transaction>& out, size_t batch_size)
+    : generator_(pattern), out_(out), batch_(std::max<size_t>(batch_size, 1)) {
+  SCP_INFO(()) << "Constructor [" << sc_time_stamp() << "]";
+  SC_THREAD(Generate);
+}
+
+void period_generator::ReferenceSystemCAgent::Generate() {
+  uint64_t total = 0;
+  while (size_t n = generator_.Generate(batch_.data(), batch_.size())) {
+    out_.PutN(batch_.data(), n);
+    total += n;
+    wait(SC_ZERO_TIME);
+  }
+  SCP_DEBUG(()) << "Pattern done after " << total << " BOCs";
+}
@@ -1,23 +1,40 @@
 #ifndef YARN_MODELS_PERIOD_GENERATOR_H_
 #define YARN_MODELS_PERIOD_GENERATOR_H_
 
+#include <systemc.h>
+
 #include <cstdint>
+#include <vector>
 
+#include "base/broadcast_channel.h"
 #include "base/channel.h"
+#include "libs/scp/report/include/scp/report.h"
 
 namespace period_generator {
 
+// One BOC cycle. Flags, type and residue share a single bit-packed word so a transaction is 8 bytes: half the padded
+// struct it replaces, i.e. twice the cycles per cache line in channel rings and trace files. The fields keep their
+// names and read as integers, so existing users (`boc.is_halted`, designated initializers) work unchanged.
 struct Transaction {
+  enum Type : uint32_t { BOC_A, BOC_B };
+  static constexpr uint32_t kResidueBits = 28;
+  static constexpr uint32_t kMaxResidue = (1u << kResidueBits) - 1;
+
   uint32_t boc_count;
-  enum { BOC_A, BOC_B } type;
-  bool is_halted;
-  bool in_KA;
-  bool is_running;
-  uint32_t residue;
+  Type type : 1;
+  uint32_t is_halted : 1;
+  uint32_t in_KA : 1;
+  uint32_t is_running : 1;
+  uint32_t residue : kResidueBits;
 };
+static_assert(sizeof(Transaction) == 8, "period_generator::Transaction must stay packed into two words");
 
 typedef yarn::ChannelGet<Transaction> Pipeline;
 
+// Fan-out from the central period generator: each BOC is written once and every model reads it through its own
+// Pipeline returned by Broadcast::Subscribe()
+typedef yarn::BroadcastChannel<Transaction> Broadcast;
+
 // So BOC cycles are transactions with a channel (Reference) that models can
 // wait upon Each Reference Model will have it's own channel it can wait on.
 // There should be a single central source for Period Generation and from that
@@ -26,8 +43,73 @@ typedef yarn::ChannelGet<Transaction> Pipeline;
 // This is a simple agent that monitors the corresponding RTL signals and drives
 // the event that way class ReferenceRTLAgent : Reference {};
 
-// Behavioral agent that models the behavior of the Period Generator
-// class ReferenceSystemCAgent : Reference {};
+// Compact pattern description. Its size depends on the number of segments, never on the number of cycles, so
+// multi-billion cycle patterns fit in a few bytes.
+struct Period {
+  uint32_t residue;  // Residue reported with every BOC of this period
+};
+
+struct Segment {
+  enum Region { kHalted, kRunning, kKeepAlive };
+
+  uint64_t cycles;                // Number of BOCs in the segment
+  uint32_t period = 0;            // Index into Pattern::periods
+  Region region = kRunning;
+  uint64_t type_sequence = 0;     // BOC types repeated over the segment, bit i set means the i-th BOC is a BOC_B
+  uint32_t type_sequence_len = 1; // Number of valid bits in type_sequence (1..64)
+};
+
+struct Pattern {
+  std::vector<Period> periods;
+  std::vector<Segment> segments;
+  uint64_t repeat = 1;  // Number of passes over segments
+};
+
+// Turns a Pattern into the BOC stream lazily, a batch at a time. After the last segment it produces one halted BOC
+// that ends the pattern for the reference models, and then nothing.
+//
+// Transaction::boc_count is 32 bits wide: a pattern with more BOCs than it can count (repeats and end marker
+// included) is reported as an error and produces only the end marker. A pattern without running BOCs is generated
+// but warned about, since the reference algorithm skips halted BOCs until the first running one and would wait for
+// it forever.
+class PatternGenerator {
+ public:
+  explicit PatternGenerator(const Pattern& pattern);
+
+  // Writes up to max transactions to out. Returns the number written, 0 once the pattern is exhausted.
+  size_t Generate(Transaction* out, size_t max);
+  bool Done() const { return done_; }
+
+ private:
+  struct CompiledSegment {
+    Segment segment;
+    uint32_t residue;
+  };
+
+  std::vector<CompiledSegment> segments_;
+  uint64_t repeat_;
+  uint64_t pass_ = 0;
+  size_t segment_ = 0;
+  uint64_t cycle_ = 0;  // BOCs already generated from the current segment
+  uint32_t boc_count_ = 0;
+  bool done_ = false;
+};
+
+// Behavioral agent that models the behavior of the Period Generator. It generates the pattern in batches and puts
+// each batch with a single PutN, then yields for a delta cycle so downstream models run chunk by chunk.
+class ReferenceSystemCAgent : public ::sc_core::sc_module {
+ public:
+  ReferenceSystemCAgent(const ::sc_core::sc_module_name&, const Pattern& pattern, yarn::ChannelPut<Transaction>& out,
+                        size_t batch_size = 256);
+
+  void Generate();
+
+ private:
+  PatternGenerator generator_;
+  yarn::ChannelPut<Transaction>& out_;
+  std::vector<Transaction> batch_;
+  SCP_LOGGER();
+};
 
 // An agent used with GoogleTest to create the C++ test suite
 // class ReferenceTestAgent : Reference {};
@@ -0,0 +1,93 @@
+#include "multi_pin.h"
+
+#include "libs/scp/report/include/scp/report.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YARN_X86 1
+#endif
+
+namespace {
+
+size_t CompareScalar(const uint64_t* captured, const uint64_t* expected, const uint64_t* mask, uint64_t* fail,
+                     size_t words) {
+  size_t failing = 0;
+  for (size_t i = 0; i < words; ++i) {
+    fail[i] = (captured[i] ^ expected[i]) & mask[i];
+    failing += __builtin_popcountll(fail[i]);
+  }
+  return failing;
+}
+
+#ifdef YARN_X86
+__attribute__((target("sse2"))) size_t CompareSse2(const uint64_t* captured, const uint64_t* expected,
+                                                   const uint64_t* mask, uint64_t* fail, size_t words) {
+  size_t failing = 0;
+  for (size_t i = 0; i < words; i += 2) {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(captured + i));
+    const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expected + i));
+    const __m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+    const __m128i f = _mm_and_si128(_mm_xor_si128(c, e), m);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(fail + i), f);
+    // Most cycles pass; only count bits when something failed
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(f, _mm_setzero_si128())) != 0xffff)
+      failing += __builtin_popcountll(fail[i]) + __builtin_popcountll(fail[i + 1]);
+  }
+  return failing;
+}
+
+__attribute__((target("avx2,popcnt"))) size_t CompareAvx2(const uint64_t* captured, const uint64_t* expected,
+                                                          const uint64_t* mask, uint64_t* fail, size_t words) {
+  size_t failing = 0;
+  for (size_t i = 0; i < words; i += 4) {
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(captured + i));
+    const __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(expected + i));
+    const __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+    const __m256i f = _mm256_and_si256(_mm256_xor_si256(c, e), m);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(fail + i), f);
+    if (!_mm256_testz_si256(f, f))
+      failing += _mm_popcnt_u64(fail[i]) + _mm_popcnt_u64(fail[i + 1]) + _mm_popcnt_u64(fail[i + 2]) +
+                 _mm_popcnt_u64(fail[i + 3]);
+  }
+  return failing;
+}
+#endif
+
+}  // namespace
+
+pin_capture::SimdLevel pin_capture::DetectSimdLevel() {
+#ifdef YARN_X86
+  static const SimdLevel level = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") ? SimdLevel::kAvx2
+                                 : __builtin_cpu_supports("sse2")                                  ? SimdLevel::kSse2
+                                                                                                   : SimdLevel::kScalar;
+  return level;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+size_t pin_capture::CompareCapture(const uint64_t* captured, const uint64_t* expected, const uint64_t* mask,
+                                   uint64_t* fail, size_t words, SimdLevel level) {
+#ifdef YARN_X86
+  // A level the CPU does not have would fault, so never go above what was detected
+  if (level > DetectSimdLevel()) level = DetectSimdLevel();
+  if (level == SimdLevel::kAvx2) return CompareAvx2(captured, expected, mask, fail, words);
+  if (level == SimdLevel::kSse2) return CompareSse2(captured, expected, mask, fail, words);
+#else
+  (void)level;
+#endif
+  return CompareScalar(captured, expected, mask, fail, words);
+}
+
+size_t pin_capture::CompareCapture(const MultiPinTransaction& transaction, PinPlane& fail) {
+  const size_t pins = transaction.captured.Pins();
+  if (fail.Pins() != pins) fail = PinPlane(pins);
+  if (transaction.expected.Pins() != pins || transaction.mask.Pins() != pins) {
+    SCP_ERR() << "BOC " << transaction.boc_count << " captured " << pins << " pins but expects "
+              << transaction.expected.Pins() << " with a mask of " << transaction.mask.Pins();
+    for (size_t pin = 0; pin < pins; ++pin) fail.Set(pin, true);
+    return pins;
+  }
+  return CompareCapture(transaction.captured.Data(), transaction.expected.Data(), transaction.mask.Data(), fail.Data(),
+                        fail.Words());
+}
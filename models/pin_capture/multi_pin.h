@@ -0,0 +1,70 @@
+#ifndef YARN_MODELS_PIN_CAPTURE_MULTI_PIN_H_
+#define YARN_MODELS_PIN_CAPTURE_MULTI_PIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multi-pin capture.
+//
+// A capture cycle of a real device covers hundreds of pins. Rather than one transaction per pin, every per-pin
+// quantity of a cycle is a PinPlane: one bit per pin, packed into 64 bit words and padded to whole 256 bit blocks, so
+// the compare kernel handles all pins of a BOC with a few wide logic ops per block and no tail loop.
+
+namespace pin_capture {
+    // One bit per pin. Padding bits past Pins() are always 0.
+    class PinPlane {
+    public:
+        static constexpr size_t kBitsPerWord = 64;
+        static constexpr size_t kWordsPerBlock = 4;  // One AVX2 register
+
+        explicit PinPlane(size_t pins = 0) :
+            pins_(pins),
+            words_((pins + kBitsPerWord * kWordsPerBlock - 1) / (kBitsPerWord * kWordsPerBlock) * kWordsPerBlock) {
+        }
+
+        size_t Pins() const { return pins_; }
+        size_t Words() const { return words_.size(); }
+        uint64_t *Data() { return words_.data(); }
+        const uint64_t *Data() const { return words_.data(); }
+
+        bool Get(size_t pin) const { return words_[pin / kBitsPerWord] >> (pin % kBitsPerWord) & 1; }
+
+        void Set(size_t pin, bool value) {
+            const uint64_t bit = uint64_t(1) << (pin % kBitsPerWord);
+            words_[pin / kBitsPerWord] = value ? words_[pin / kBitsPerWord] | bit : words_[pin / kBitsPerWord] & ~bit;
+        }
+
+    private:
+        size_t pins_;
+        std::vector<uint64_t> words_;
+    };
+
+    // What the device drove on its pins in one BOC cycle, against what the pattern expected
+    struct MultiPinTransaction {
+        uint32_t boc_count;
+        PinPlane captured;
+        PinPlane expected;
+        PinPlane mask;  // Pins that are compared this cycle
+    };
+
+    // Instruction set a compare kernel is built for
+    enum class SimdLevel { kScalar, kSse2, kAvx2 };
+
+    // The best level this CPU supports, checked once
+    SimdLevel DetectSimdLevel();
+
+    // fail = (captured ^ expected) & mask over `words` words (a multiple of PinPlane::kWordsPerBlock). Returns the
+    // number of failing pins.
+    size_t CompareCapture(const uint64_t *captured, const uint64_t *expected, const uint64_t *mask, uint64_t *fail,
+                          size_t words, SimdLevel level = DetectSimdLevel());
+
+    // Compares all pins of one cycle into fail (resized to match). Returns the number of failing pins.
+    //
+    // expected and mask must cover as many pins as captured. A transaction whose planes differ is reported as an error
+    // and, should the report return, none of its pins pass: fail is set for every captured pin and their number is
+    // returned.
+    size_t CompareCapture(const MultiPinTransaction &transaction, PinPlane &fail);
+} // namespace pin_capture
+
+#endif  // YARN_MODELS_PIN_CAPTURE_MULTI_PIN_H_
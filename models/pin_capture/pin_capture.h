@@ -3,6 +3,8 @@
 
 #include <systemc.h>
 
+#include <array>
+#include <deque>
 #include <string>
 
 #include "base/channel.h"
@@ -19,53 +21,255 @@ namespace state_bus {
 } // namespace state_bus
 
 namespace pin_capture {
+    struct Transaction {
+        uint32_t data;
+    };
+
+    typedef yarn::ChannelGet<Transaction> Pipeline;
+
+    // The reference algorithm itself, free of any SystemC. Reference runs it inside the kernel and RunStandalone() (see
+    // standalone.h) runs it straight over recorded streams; both build every word with the same Capture() and batch
+    // them the same way, so their output is bit-identical.
+    //
+    // Run() blocks on its inputs. Source provides AwaitBoc(), GetStateBusTransaction() and EmitTransactions(); when it
+    // is the most derived (final) type those calls bind statically and inline. Step() is the same sequence for method
+    // processes: it stops where an input is missing instead of blocking and picks up from there on the next call.
+    class Algorithm {
+    public:
+        // Outgoing transactions are collected and handed to EmitTransactions() in batches of up to this many
+        static constexpr size_t kEmitBatchSize = 64;
+
+        // Capture word for one running BOC.
+        //
+        // PLACEHOLDER, not reference behaviour: there is no device specification for the capture word in this tree,
+        // so this layout is made up to carry what the algorithm knows about the cycle. Do not compare it against
+        // hardware or use it as golden data. Reference and RunStandalone() both build the word here, so the device
+        // format only has to replace this function.
+        //   [31]    BOC type (1 = BOC_B)
+        //   [30]    keep-alive, the BOC's own in_KA flag
+        //   [29:0]  residue plus the state bus BOC_A count
+        static Transaction Capture(const period_generator::Transaction &boc, const state_bus::Transaction &state_bus) {
+            return {(static_cast<uint32_t>(boc.type) << 31) | (static_cast<uint32_t>(boc.in_KA) << 30) |
+                    ((boc.residue + state_bus.boc_a_count) & 0x3fffffffu)};
+        }
+
+        template<class Source>
+        void Run(Source &source);
+
+        // Never blocks. Source provides TryAwaitBoc(), TryGetStateBusTransaction() and EmitTransactions(); the Try calls
+        // return false when there is nothing to take yet, and so does Step(). Returns true once the pattern has ended.
+        template<class Source>
+        bool Step(Source &source);
+
+        // Emits whatever is batched up
+        template<class Sink>
+        void Flush(Sink &sink) {
+            if (!pending_) return;
+            sink.EmitTransactions(batch_.data(), pending_);
+            pending_ = 0;
+        }
+
+    private:
+        template<class Sink>
+        void Emit(const Transaction &transaction, Sink &sink) {
+            batch_[pending_++] = transaction;
+            if (pending_ == batch_.size()) Flush(sink);
+        }
+
+        std::array<Transaction, kEmitBatchSize> batch_;
+        size_t pending_ = 0;
+
+        // Where Step() stopped: the BOC it holds, if any, and whether the first running one has been seen
+        enum class Phase { kHalted, kRunning, kEnded };
+        Phase phase_ = Phase::kHalted;
+        bool boc_pending_ = false;
+        period_generator::Transaction boc_;
+    };
+
+    template<class Source>
+    void Algorithm::Run(Source &source) {
+        // Get the next BOC
+        auto boc = source.AwaitBoc();
+
+        // Wait for 1st running transaction - as we will see default periods in the beginning. A pattern without one
+        // (PatternGenerator warns about it) leaves this blocked on its end marker.
+        while (boc.is_halted) boc = source.AwaitBoc();
+
+        // Generate transactions while pattern is runnign
+        while (boc.is_running) {
+            // Get data from all interfaces - These methods
+            state_bus::Transaction state_bus = source.GetStateBusTransaction();
+
+            Emit(Capture(boc, state_bus), source);
+
+            // wait for next BOC Cycle
+            boc = source.AwaitBoc();
+        }
+        Flush(source);
+    }
+
+    template<class Source>
+    bool Algorithm::Step(Source &source) {
+        while (phase_ != Phase::kEnded) {
+            if (!boc_pending_ && !source.TryAwaitBoc(boc_)) return false;
+            boc_pending_ = true;
+            // The same sequence as Run(): skip the default periods, then capture while the pattern is running
+            if (phase_ == Phase::kHalted && boc_.is_halted) {
+                boc_pending_ = false;
+                continue;
+            }
+            phase_ = Phase::kRunning;
+            if (!boc_.is_running) {
+                boc_pending_ = false;
+                phase_ = Phase::kEnded;
+                Flush(source);
+                break;
+            }
+            state_bus::Transaction state_bus;
+            if (!source.TryGetStateBusTransaction(state_bus)) return false;
+            boc_pending_ = false;
+            Emit(Capture(boc_, state_bus), source);
+        }
+        return true;
+    }
+
     // Abstract top transaction layer. This is where the meat of the code goes.
     // Responsible for calculating transaction based on BOC cycles
+    //
+    // In the kernel the model is an SC_METHOD running Resume(), so it costs no thread context switch per BOC.
     class Reference : ::sc_core::sc_module {
     public:
         explicit Reference(const ::sc_core::sc_module_name &);
 
-        void Start();
+        // Runs the whole reference algorithm through the blocking interface below, from a thread or outside the kernel
+        // (this is what the mocks use)
+        virtual void Start() { Run(*this); }
 
         std::string Name() const { return {name()}; }
 
+        static constexpr size_t kEmitBatchSize = Algorithm::kEmitBatchSize;
+
     private:
         const std::string name_;
+        Algorithm algorithm_;
         SCP_LOGGER();
 
+        friend class Algorithm;
+
     protected:
         virtual period_generator::Transaction AwaitBoc() = 0;
 
         virtual state_bus::Transaction GetStateBusTransaction() = 0;
 
         // FIXME: Add GetMethod's for other Pin Capture interfaces
+
+        // Receives consecutive outgoing transactions, oldest first
+        virtual void EmitTransactions(const Transaction *transactions, size_t n) = 0;
+
+        // The body of the SC_METHOD: advances the algorithm as far as the inputs allow and re-arms itself with
+        // next_trigger() on whatever it waits for
+        virtual void Resume() = 0;
+
+        template<class Source>
+        void Run(Source &source) { algorithm_.Run(source); }
+
+        template<class Source>
+        bool Step(Source &source) { return algorithm_.Step(source); }
+
+        // Emits whatever is batched up. Agents call this before blocking on input so a batch never waits on a BOC
+        // that has not been generated yet.
+        template<class Sink>
+        void Flush(Sink &sink) { algorithm_.Flush(sink); }
     };
 
     // ReferenceAgent sits in-between the Reference Model and the Wire layer (that defines the fields of a transaction)
     // There can be several different agents depending on where the Reference Model is used (Block, System, Stand alone,
     // Google Test etc.)
-    class ReferenceAgent : public Reference {
+    //
+    // The channel types are template parameters. With the defaults every get and put is a virtual call through the
+    // pipeline interfaces; with concrete channels (see ChannelReferenceAgent) the whole per-BOC path is resolved at
+    // compile time.
+    //
+    // Resume() reads the inputs with TryGet() and waits for them with next_trigger() on their PutEvent(). Output the out
+    // channel has no room for is held back, and no further BOC is taken, until it does.
+    template<class PerGenChannel = period_generator::Pipeline, class StateBusChannel = state_bus::Pipeline,
+             class OutChannel = yarn::ChannelPut<Transaction> >
+    class ReferenceAgent final : public Reference {
     private:
-        period_generator::Pipeline &per_gen_;
-        state_bus::Pipeline &state_bus_pipeline_;
+        PerGenChannel &per_gen_;
+        StateBusChannel &state_bus_pipeline_;
+        OutChannel &out_;
         state_bus::Transaction current_transaction_;
+        std::deque<Transaction> backlog_;
+
+        friend class Algorithm;
+
+        // The channels as Resume() sees them, where nothing blocks
+        class MethodSource final {
+        public:
+            explicit MethodSource(ReferenceAgent &agent) : agent_(agent) {
+            }
+
+            bool TryAwaitBoc(period_generator::Transaction &boc) {
+                if (!agent_.per_gen_.Size()) agent_.Flush(*this);
+                // Resume() re-arms on room in the output
+                if (!agent_.backlog_.empty()) return false;
+                if (agent_.per_gen_.TryGet(boc)) return true;
+                next_trigger(agent_.per_gen_.PutEvent());
+                return false;
+            }
+
+            bool TryGetStateBusTransaction(state_bus::Transaction &state_bus) {
+                if (agent_.state_bus_pipeline_.TryGet(state_bus)) return true;
+                next_trigger(agent_.state_bus_pipeline_.PutEvent());
+                return false;
+            }
+
+            void EmitTransactions(const Transaction *transactions, size_t n) {
+                agent_.backlog_.insert(agent_.backlog_.end(), transactions, transactions + n);
+                agent_.DrainBacklog();
+            }
+
+        private:
+            ReferenceAgent &agent_;
+        };
+
+        void DrainBacklog() {
+            while (!backlog_.empty() && out_.TryPut(backlog_.front())) backlog_.pop_front();
+        }
 
     public:
-        ReferenceAgent(const ::sc_core::sc_module_name &,
-                       period_generator::Pipeline &period_generator,
-                       state_bus::Pipeline &state_bus_pipeline);
+        ReferenceAgent(const ::sc_core::sc_module_name &sc_name,
+                       PerGenChannel &period_generator,
+                       StateBusChannel &state_bus_pipeline,
+                       OutChannel &out) :
+            Reference(sc_name), per_gen_(period_generator), state_bus_pipeline_(state_bus_pipeline), out_(out),
+            current_transaction_() {
+        }
+
+        void Start() override { Run(*this); }
 
     protected:
-        period_generator::Transaction AwaitBoc() override;
+        period_generator::Transaction AwaitBoc() final {
+            if (!per_gen_.Size()) Flush(*this);
+            return per_gen_.Get();
+        }
 
-        state_bus::Transaction GetStateBusTransaction() override;
-    };
+        state_bus::Transaction GetStateBusTransaction() final { return state_bus_pipeline_.Get(); }
 
-    struct Transaction {
-        uint32_t data;
+        void EmitTransactions(const Transaction *transactions, size_t n) final { out_.PutN(transactions, n); }
+
+        void Resume() final {
+            DrainBacklog();
+            MethodSource source(*this);
+            if (backlog_.empty()) Step(source);
+            if (!backlog_.empty()) next_trigger(out_.GetEvent());
+        }
     };
 
-    typedef yarn::ChannelGet<Transaction> Pipeline;
+    typedef ReferenceAgent<yarn::Channel<period_generator::Transaction>, yarn::Channel<state_bus::Transaction>,
+                           yarn::Channel<Transaction> >
+    ChannelReferenceAgent;
 } // namespace pin_capture
 
 #endif  // YARN_MODELS_PIN_CAPTURE_H_
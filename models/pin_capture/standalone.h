@@ -0,0 +1,71 @@
+#ifndef YARN_MODELS_PIN_CAPTURE_STANDALONE_H_
+#define YARN_MODELS_PIN_CAPTURE_STANDALONE_H_
+
+#include <cstddef>
+
+#include "base/trace.h"
+#include "models/pin_capture/pin_capture.h"
+
+// Kernel-free fast path for golden model regressions.
+//
+// RunStandalone() feeds BOC and state bus streams that are already in memory (plain arrays or mapped trace files)
+// straight into pin_capture::Algorithm in a tight loop. No process is scheduled and no event is notified, but the
+// algorithm is the very same code Reference runs inside the kernel (Run() here, the resumable Step() there).
+
+namespace pin_capture {
+    namespace standalone {
+        template<class T>
+        const T &Item(const T &item) { return item; }
+
+        template<class T>
+        const T &Item(const yarn::TraceRecord<T> &record) { return record.data; }
+
+        // Serves the streams to the algorithm. Running off the end of the BOC stream reads as a BOC that is neither
+        // halted nor running, which ends the run; running off the end of the state bus reads as an idle bus.
+        template<class BocItem, class StateBusItem, class Sink>
+        class Source final {
+        public:
+            Source(const BocItem *bocs, size_t n_bocs, const StateBusItem *state_bus, size_t n_state_bus, Sink &sink) :
+                bocs_(bocs), bocs_end_(bocs + n_bocs), state_bus_(state_bus), state_bus_end_(state_bus + n_state_bus),
+                sink_(sink) {
+            }
+
+            period_generator::Transaction AwaitBoc() {
+                return bocs_ != bocs_end_ ? Item(*bocs_++) : period_generator::Transaction();
+            }
+
+            state_bus::Transaction GetStateBusTransaction() {
+                return state_bus_ != state_bus_end_ ? Item(*state_bus_++) : state_bus::Transaction();
+            }
+
+            void EmitTransactions(const Transaction *transactions, size_t n) { sink_(transactions, n); }
+
+        private:
+            const BocItem *bocs_;
+            const BocItem *const bocs_end_;
+            const StateBusItem *state_bus_;
+            const StateBusItem *const state_bus_end_;
+            Sink &sink_;
+        };
+    } // namespace standalone
+
+    // Runs the reference algorithm over n_bocs BOCs and the matching state bus transactions. Sink is called as
+    // sink(const Transaction *transactions, size_t n) for every batch the algorithm emits. The items may be the
+    // transactions themselves or yarn::TraceRecord's wrapping them.
+    template<class BocItem, class StateBusItem, class Sink>
+    void RunStandalone(const BocItem *bocs, size_t n_bocs, const StateBusItem *state_bus, size_t n_state_bus,
+                       Sink &&sink) {
+        standalone::Source<BocItem, StateBusItem, Sink> source(bocs, n_bocs, state_bus, n_state_bus, sink);
+        Algorithm algorithm;
+        algorithm.Run(source);
+    }
+
+    // Runs the reference algorithm over recorded traces (see base/trace.h)
+    template<class Sink>
+    void RunStandalone(const yarn::TraceReader<period_generator::Transaction> &bocs,
+                       const yarn::TraceReader<state_bus::Transaction> &state_bus, Sink &&sink) {
+        RunStandalone(bocs.begin(), bocs.Size(), state_bus.begin(), state_bus.Size(), sink);
+    }
+} // namespace pin_capture
+
+#endif  // YARN_MODELS_PIN_CAPTURE_STANDALONE_H_
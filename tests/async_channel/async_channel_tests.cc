@@ -0,0 +1,78 @@
+#include <gmock/gmock.h>
+
+#include <time.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "base/async_channel.h"
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "systemc.h"
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(scp::LogConfig()
+                    .logLevel(scp::log::WARNING)
+                    .logAsync(false)
+                    .printSimTime(false));
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+using yarn::AsyncChannel;
+
+// CPU time used by the calling thread
+std::chrono::nanoseconds ThreadCpuTime() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+// An AsyncChannel is a primitive channel, so it has to exist before the first sc_start, and it holds the kernel while
+// attached. That leaves room for a single simulation per process, hence a binary of its own.
+TEST(async_channel_tests, worker_round_trip) {
+  constexpr int kItems = 1000;
+  AsyncChannel<int> to_worker("to_worker", 3);
+  AsyncChannel<int> from_worker("from_worker", 3);
+  // Nobody takes from this one
+  AsyncChannel<int> exact("exact", 3);
+  std::vector<int> got;
+  std::chrono::nanoseconds worker_cpu{};
+
+  sc_spawn([&]() {
+    // The depth is exact even though the storage behind it is rounded up to 4
+    for (int i = 0; i < 3; ++i) EXPECT_TRUE(exact.TryPut(i));
+    EXPECT_FALSE(exact.TryPut(3));
+    exact.Close();
+    // Keeps the worker waiting on an idle simulation for a while
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (int i = 0; i < kItems; ++i) to_worker.Put(i);
+  });
+  sc_spawn([&]() {
+    for (int i = 0; i < kItems; ++i) got.push_back(from_worker.Get());
+  });
+  std::thread worker([&]() {
+    const auto start = ThreadCpuTime();
+    for (int i = 0; i < kItems; ++i) from_worker.Push(2 * to_worker.Pop());
+    worker_cpu = ThreadCpuTime() - start;
+    to_worker.Close();
+    from_worker.Close();
+  });
+
+  // Only returns once the worker has closed both channels
+  sc_start();
+  worker.join();
+
+  ASSERT_EQ(static_cast<size_t>(kItems), got.size());
+  for (int i = 0; i < kItems; ++i) ASSERT_EQ(2 * i, got[i]);
+  EXPECT_EQ(0u, to_worker.Size());
+  EXPECT_EQ(0u, from_worker.Size());
+  // A worker spinning in Pop would have used most of the 100 ms
+  EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(worker_cpu).count(), 50);
+}
+}  // namespace
@@ -0,0 +1,487 @@
+#include <gmock/gmock.h>
+
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/broadcast_channel.h"
+#include "base/channel.h"
+#include "base/trace.h"
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "systemc.h"
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(scp::LogConfig()
+                    .logLevel(scp::log::WARNING)
+                    .logAsync(false)
+                    .printSimTime(false));
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+using yarn::BroadcastChannel;
+using yarn::Channel;
+
+// Counts how often it is copied
+struct Counted {
+  static int copies;
+  int value = 0;
+  Counted(int v = 0) : value(v) {}
+  Counted(const Counted& other) : value(other.value) { ++copies; }
+  Counted(Counted&&) = default;
+  Counted& operator=(const Counted& other) {
+    value = other.value;
+    ++copies;
+    return *this;
+  }
+  Counted& operator=(Counted&&) = default;
+};
+int Counted::copies = 0;
+
+// Runs every body as its own thread process for at most limit and returns how many of them ran to the end. Channel
+// calls notify events, so they have to be made from a process rather than from the test itself.
+size_t RunProcesses(const std::vector<std::function<void()>>& bodies, const sc_time& limit = sc_time(1, SC_US)) {
+  auto finished = std::make_shared<size_t>(0);
+  for (const auto& body : bodies)
+    sc_spawn([body, finished]() {
+      body();
+      ++*finished;
+    });
+  sc_start(limit);
+  return *finished;
+}
+
+TEST(channel_tests, ring_wraps_around) {
+  Channel<int> channel("ring_wraps_around", 4);
+  std::vector<int> got;
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    // Rounds of 3 against a capacity of 4 move head and tail across the end of the ring
+    for (int round = 0; round < 5; ++round) {
+      for (int i = 0; i < 3; ++i) channel.Put(round * 3 + i);
+      EXPECT_EQ(3u, channel.Size());
+      for (int i = 0; i < 3; ++i) got.push_back(channel.Get());
+    }
+  }}));
+  ASSERT_EQ(15u, got.size());
+  for (int i = 0; i < 15; ++i) EXPECT_EQ(i, got[i]);
+}
+
+TEST(channel_tests, producer_blocks_on_a_full_ring) {
+  Channel<int> channel("producer_blocks_on_a_full_ring", 2);
+  std::vector<int> got;
+  sc_time done;
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                const sc_time start = sc_time_stamp();
+                                for (int i = 0; i < 6; ++i) channel.Put(i);
+                                done = sc_time_stamp() - start;
+                              },
+                              [&]() {
+                                for (int i = 0; i < 6; ++i) {
+                                  wait(10, SC_NS);
+                                  got.push_back(channel.Get());
+                                }
+                              }}));
+  // The last 4 puts each wait for a get, the last of them at 40 ns
+  EXPECT_EQ(sc_time(40, SC_NS), done);
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5}), got);
+}
+
+TEST(channel_tests, consumer_blocks_on_an_empty_ring) {
+  Channel<int> channel("consumer_blocks_on_an_empty_ring", 4);
+  sc_time waited;
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                wait(25, SC_NS);
+                                channel.Put(7);
+                              },
+                              [&]() {
+                                const sc_time start = sc_time_stamp();
+                                EXPECT_EQ(7, channel.Get());
+                                waited = sc_time_stamp() - start;
+                              }}));
+  EXPECT_EQ(sc_time(25, SC_NS), waited);
+}
+
+TEST(channel_tests, deep_channels_use_the_deque) {
+  // One past the largest ring; a ring would round this up to 2^21 slots
+  const uint64_t depth = Channel<int>::kMaxRingDepth + 1;
+  Channel<int> channel("deep_channels_use_the_deque", depth);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    for (uint64_t i = 0; i < depth; ++i) ASSERT_TRUE(channel.TryPut(static_cast<int>(i)));
+    EXPECT_FALSE(channel.TryPut(-1));
+    EXPECT_EQ(depth, channel.Size());
+    for (uint64_t i = 0; i < depth; ++i) ASSERT_EQ(static_cast<int>(i), channel.Get());
+  }}));
+}
+
+TEST(channel_tests, unbounded_channels_never_block) {
+  Channel<int> channel("unbounded_channels_never_block");
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    const sc_time start = sc_time_stamp();
+    for (int i = 0; i < 1000; ++i) channel.Put(i);
+    EXPECT_EQ(start, sc_time_stamp());
+    EXPECT_EQ(1000u, channel.Size());
+    for (int i = 0; i < 1000; ++i) ASSERT_EQ(i, channel.Get());
+  }}));
+}
+
+TEST(channel_tests, zero_depth_is_rejected) {
+  const auto actions = sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, sc_core::SC_DISPLAY);
+  const auto errors = sc_core::sc_report_handler::get_count(sc_core::SC_ERROR);
+  Channel<int> channel("zero_depth_is_rejected", 0);
+  sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, actions);
+  EXPECT_EQ(errors + 1, sc_core::sc_report_handler::get_count(sc_core::SC_ERROR));
+}
+
+TEST(channel_tests, put_n_fills_whatever_room_there_is) {
+  Channel<int> channel("put_n_fills_whatever_room_there_is", 4);
+  std::vector<int> got;
+  sc_time done;
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                const sc_time start = sc_time_stamp();
+                                std::vector<int> burst;
+                                for (int i = 0; i < 10; ++i) burst.push_back(i);
+                                channel.PutN(burst);
+                                done = sc_time_stamp() - start;
+                              },
+                              [&]() {
+                                wait(10, SC_NS);
+                                for (int i = 0; i < 10; ++i) {
+                                  got.push_back(channel.Get());
+                                  wait(1, SC_NS);
+                                }
+                              }}));
+  // 4 go in at once; the other 6 follow the gets at 10 .. 15 ns
+  EXPECT_EQ(sc_time(15, SC_NS), done);
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), got);
+}
+
+TEST(channel_tests, get_n_takes_what_is_there) {
+  Channel<int> channel("get_n_takes_what_is_there", 8);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    const int burst[] = {1, 2, 3};
+    channel.PutN(burst, 3);
+    int out[8] = {};
+    EXPECT_EQ(3u, channel.GetN(out, 8));
+    EXPECT_EQ(1, out[0]);
+    EXPECT_EQ(3, out[2]);
+    EXPECT_EQ(0u, channel.Size());
+    EXPECT_EQ(0u, channel.GetN(out, 0));
+  }}));
+}
+
+TEST(channel_tests, get_n_blocks_until_a_put_n) {
+  Channel<int> channel("get_n_blocks_until_a_put_n", 8);
+  size_t n = 0;
+  sc_time waited;
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                wait(5, SC_NS);
+                                const int burst[] = {4, 5, 6};
+                                channel.PutN(burst, 3);
+                              },
+                              [&]() {
+                                const sc_time start = sc_time_stamp();
+                                int out[2] = {};
+                                n = channel.GetN(out, 2);
+                                waited = sc_time_stamp() - start;
+                                EXPECT_EQ(4, out[0]);
+                                EXPECT_EQ(5, out[1]);
+                              }}));
+  EXPECT_EQ(2u, n);
+  EXPECT_EQ(sc_time(5, SC_NS), waited);
+  EXPECT_EQ(1u, channel.Size());
+}
+
+TEST(channel_tests, peek_refers_into_the_channel_until_consume) {
+  Channel<int> channel("peek_refers_into_the_channel_until_consume", 4);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    channel.Put(1);
+    channel.Put(2);
+    const int& first = channel.Peek();
+    EXPECT_EQ(1, first);
+    EXPECT_EQ(&first, &channel.Peek());
+    EXPECT_EQ(2u, channel.Size());
+    channel.Consume();
+    EXPECT_EQ(2, channel.Peek());
+    EXPECT_EQ(1u, channel.Size());
+    channel.Consume();
+    EXPECT_EQ(0u, channel.Size());
+  }}));
+}
+
+TEST(channel_tests, peek_blocks_until_a_put) {
+  Channel<int> channel("peek_blocks_until_a_put", 4);
+  sc_time waited;
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                wait(8, SC_NS);
+                                channel.Put(3);
+                              },
+                              [&]() {
+                                const sc_time start = sc_time_stamp();
+                                EXPECT_EQ(3, channel.Peek());
+                                waited = sc_time_stamp() - start;
+                                channel.Consume();
+                              }}));
+  EXPECT_EQ(sc_time(8, SC_NS), waited);
+  EXPECT_EQ(0u, channel.Size());
+}
+
+TEST(channel_tests, emplace_and_move_never_copy) {
+  Channel<Counted> channel("emplace_and_move_never_copy", 4);
+  Counted::copies = 0;
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    channel.Emplace(1);
+    channel.Put(Counted(2));
+    Counted third(3);
+    EXPECT_TRUE(channel.TryPut(std::move(third)));
+    EXPECT_EQ(1, channel.Peek().value);
+    channel.Consume();
+    EXPECT_EQ(2, channel.Get().value);
+    Counted out;
+    EXPECT_TRUE(channel.TryGet(out));
+    EXPECT_EQ(3, out.value);
+  }}));
+  EXPECT_EQ(0, Counted::copies);
+}
+
+TEST(channel_tests, move_only_items) {
+  Channel<std::unique_ptr<int>> channel("move_only_items", 1);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    channel.Put(std::make_unique<int>(1));
+    auto second = std::make_unique<int>(2);
+    EXPECT_FALSE(channel.TryPut(std::move(second)));
+    ASSERT_TRUE(second);  // Left untouched by the failed put
+    EXPECT_EQ(1, *channel.Get());
+    EXPECT_TRUE(channel.TryPut(std::move(second)));
+    EXPECT_EQ(2, *channel.Get());
+    channel.Emplace(new int(3));
+    EXPECT_EQ(3, *channel.Peek());
+    channel.Consume();
+
+    // A copying put through the interface cannot work
+    const auto actions = sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, sc_core::SC_DISPLAY);
+    const auto errors = sc_core::sc_report_handler::get_count(sc_core::SC_ERROR);
+    yarn::ChannelPut<std::unique_ptr<int>>& put = channel;
+    const auto item = std::make_unique<int>(4);
+    put.Put(item);
+    EXPECT_FALSE(put.TryPut(item));
+    sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, actions);
+    EXPECT_EQ(errors + 2, sc_core::sc_report_handler::get_count(sc_core::SC_ERROR));
+    EXPECT_EQ(0u, channel.Size());
+  }}));
+}
+
+TEST(channel_tests, broadcast_backpressure_follows_the_slowest_reader) {
+  BroadcastChannel<int> channel("broadcast_backpressure_follows_the_slowest_reader", 2);
+  auto& fast = channel.Subscribe("fast");
+  auto& slow = channel.Subscribe("slow");
+  std::vector<int> fast_got;
+  std::vector<int> slow_got;
+  sc_time done;
+  ASSERT_EQ(3u, RunProcesses({[&]() {
+                                const sc_time start = sc_time_stamp();
+                                for (int i = 0; i < 6; ++i) channel.Put(i);
+                                done = sc_time_stamp() - start;
+                              },
+                              [&]() {
+                                for (int i = 0; i < 6; ++i) fast_got.push_back(fast.Get());
+                              },
+                              [&]() {
+                                for (int i = 0; i < 6; ++i) {
+                                  wait(10, SC_NS);
+                                  slow_got.push_back(slow.Get());
+                                }
+                              }}));
+  // The fast reader keeps up, so every put past the first two waits for a get of the slow one
+  EXPECT_EQ(sc_time(40, SC_NS), done);
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5}), fast_got);
+  EXPECT_EQ(fast_got, slow_got);
+  EXPECT_EQ(0u, channel.Size());
+}
+
+TEST(channel_tests, broadcast_without_subscribers_drops_items) {
+  BroadcastChannel<int> channel("broadcast_without_subscribers_drops_items", 2);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    const sc_time start = sc_time_stamp();
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(channel.TryPut(i));
+    channel.Put(10);
+    EXPECT_EQ(start, sc_time_stamp());
+    EXPECT_EQ(0u, channel.Size());
+  }}));
+}
+
+TEST(channel_tests, try_put_and_try_get_never_block) {
+  Channel<int> channel("try_put_and_try_get_never_block", 2);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    const sc_time start = sc_time_stamp();
+    int d = -1;
+    EXPECT_FALSE(channel.TryGet(d));
+    EXPECT_EQ(-1, d);
+    EXPECT_TRUE(channel.TryPut(1));
+    EXPECT_TRUE(channel.TryPut(2));
+    EXPECT_FALSE(channel.TryPut(3));
+    EXPECT_EQ(2u, channel.Size());
+    EXPECT_TRUE(channel.TryGet(d));
+    EXPECT_EQ(1, d);
+    EXPECT_EQ(start, sc_time_stamp());
+  }}));
+}
+
+TEST(channel_tests, get_with_timeout) {
+  Channel<int> channel("get_with_timeout", 2);
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                wait(30, SC_NS);
+                                channel.Put(5);
+                              },
+                              [&]() {
+                                const sc_time start = sc_time_stamp();
+                                int d = -1;
+                                // Nothing arrives within the first 20 ns
+                                EXPECT_FALSE(channel.Get(d, sc_time(20, SC_NS)));
+                                EXPECT_EQ(-1, d);
+                                EXPECT_EQ(sc_time(20, SC_NS), sc_time_stamp() - start);
+                                // The put at 30 ns ends the wait early
+                                EXPECT_TRUE(channel.Get(d, sc_time(50, SC_NS)));
+                                EXPECT_EQ(5, d);
+                                EXPECT_EQ(sc_time(30, SC_NS), sc_time_stamp() - start);
+                              }}));
+}
+
+TEST(channel_tests, method_processes_use_try_and_next_trigger) {
+  constexpr int kItems = 10;
+  Channel<int> channel("method_processes_use_try_and_next_trigger", 2);
+  int sent = 0;
+  std::vector<int> got;
+  sc_spawn_options options;
+  options.spawn_method();
+  sc_spawn(
+      [&]() {
+        while (sent < kItems && channel.TryPut(sent)) ++sent;
+        if (sent < kItems) next_trigger(channel.GetEvent());
+      },
+      "producer", &options);
+  sc_spawn(
+      [&]() {
+        int d;
+        while (channel.TryGet(d)) got.push_back(d);
+        if (got.size() < kItems) next_trigger(channel.PutEvent());
+      },
+      "consumer", &options);
+  sc_start(sc_time(1, SC_US));
+
+  ASSERT_EQ(static_cast<size_t>(kItems), got.size());
+  for (int i = 0; i < kItems; ++i) EXPECT_EQ(i, got[i]);
+}
+
+TEST(channel_tests, trace_round_trip) {
+  struct Sample {
+    uint32_t pin;
+    uint32_t value;
+  };
+  const std::string file_name = "/tmp/yarn_trace_test." + std::to_string(getpid());
+  Channel<Sample> channel("trace_round_trip", 8);
+  yarn::TraceRecorder<Sample> recorder(file_name);
+  channel.Attach(&recorder);
+  sc_time start;
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    start = sc_time_stamp();
+    for (uint32_t i = 0; i < 3; ++i) channel.Put({i, 10 * i});
+    wait(10, SC_NS);
+    const Sample burst[] = {{3, 30}, {4, 40}};
+    channel.PutN(burst, 2);
+  }}));
+  channel.Attach(nullptr);
+  EXPECT_TRUE(recorder.Close());
+  EXPECT_EQ(5u, recorder.Count());
+
+  {
+    yarn::TraceReader<Sample> reader(file_name);
+    ASSERT_TRUE(reader.IsOpen());
+    ASSERT_EQ(5u, reader.Size());
+    EXPECT_EQ(static_cast<uint64_t>(sc_time::from_value(1).to_seconds() * 1e15 + 0.5), reader.ResolutionFs());
+    EXPECT_EQ(start.value(), reader[2].time);
+    EXPECT_EQ((start + sc_time(10, SC_NS)).value(), reader[3].time);
+  }
+
+  yarn::TraceReplay<Sample> replay("trace_round_trip_replay", file_name);
+  ASSERT_EQ(1u, RunProcesses({[&]() {
+    for (uint32_t i = 0; i < 5; ++i) {
+      const Sample sample = replay.Get();
+      EXPECT_EQ(i, sample.pin);
+      EXPECT_EQ(10 * i, sample.value);
+    }
+    Sample sample;
+    EXPECT_FALSE(replay.TryGet(sample));
+    EXPECT_EQ(0u, replay.Remaining());
+  }}));
+  std::remove(file_name.c_str());
+}
+
+TEST(channel_tests, trace_recorder_reports_a_failed_open) {
+  const auto actions = sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, sc_core::SC_DISPLAY);
+  const auto errors = sc_core::sc_report_handler::get_count(sc_core::SC_ERROR);
+  yarn::TraceRecorder<int> recorder("/nonexistent/yarn_trace_test");
+  EXPECT_FALSE(recorder.Close());
+  sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, actions);
+  EXPECT_EQ(errors + 1, sc_core::sc_report_handler::get_count(sc_core::SC_ERROR));
+}
+
+#ifdef YARN_CHANNEL_STATS
+const yarn::ChannelStats* FindStats(const std::string& name) {
+  for (const yarn::ChannelStats* stats : yarn::ChannelStats::Registry())
+    if (stats->Name() == name) return stats;
+  return nullptr;
+}
+
+// Bucket a latency of t lands in, see ChannelStats::kLatencyBuckets
+size_t LatencyBucket(const sc_time& t) {
+  size_t bucket = 0;
+  for (uint64_t v = t.value(); v; v >>= 1) ++bucket;
+  return bucket;
+}
+
+TEST(channel_tests, stats_count_traffic_occupancy_and_latency) {
+  Channel<int> channel("stats_count_traffic_occupancy_and_latency", 4);
+  const yarn::ChannelStats* stats = FindStats(channel.Name());
+  ASSERT_NE(nullptr, stats);
+  ASSERT_EQ(2u, RunProcesses({[&]() {
+                                wait(5, SC_NS);
+                                for (int i = 0; i < 3; ++i) channel.Put(i);
+                              },
+                              [&]() {
+                                const sc_time start = sc_time_stamp();
+                                channel.Get();  // Waits 5 ns, leaves with no latency
+                                wait(start + sc_time(15, SC_NS) - sc_time_stamp());
+                                channel.Get();  // 10 ns in the channel
+                                wait(20, SC_NS);
+                                channel.Get();  // 30 ns in the channel
+                              }}));
+  EXPECT_EQ(3u, stats->Puts());
+  EXPECT_EQ(3u, stats->Gets());
+  EXPECT_EQ(3u, stats->MaxOccupancy());
+  EXPECT_EQ(SC_ZERO_TIME, stats->PutBlocked());
+  EXPECT_EQ(sc_time(5, SC_NS), stats->GetBlocked());
+
+  std::array<uint64_t, yarn::ChannelStats::kLatencyBuckets> latency{};
+  ++latency[0];
+  ++latency[LatencyBucket(sc_time(10, SC_NS))];
+  ++latency[LatencyBucket(sc_time(30, SC_NS))];
+  EXPECT_EQ(latency, stats->Latency());
+}
+
+TEST(channel_tests, stats_leave_the_registry_with_their_channel) {
+  {
+    Channel<int> channel("stats_leave_the_registry_with_their_channel");
+    EXPECT_NE(nullptr, FindStats(channel.Name()));
+  }
+  EXPECT_EQ(nullptr, FindStats("stats_leave_the_registry_with_their_channel"));
+}
+#endif  // YARN_CHANNEL_STATS
+}  // namespace
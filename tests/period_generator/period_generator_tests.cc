@@ -0,0 +1,99 @@
+#include <gmock/gmock.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "models/period_generator/period_generator.h"
+#include "systemc.h"
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(scp::LogConfig()
+                    .logLevel(scp::log::WARNING)
+                    .logAsync(false)
+                    .printSimTime(false));
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+using period_generator::Pattern;
+using period_generator::PatternGenerator;
+using period_generator::Segment;
+using period_generator::Transaction;
+
+std::vector<Transaction> GenerateAll(PatternGenerator& generator, size_t batch) {
+  std::vector<Transaction> all;
+  std::vector<Transaction> chunk(batch);
+  while (size_t n = generator.Generate(chunk.data(), chunk.size())) all.insert(all.end(), chunk.begin(), chunk.begin() + n);
+  return all;
+}
+
+TEST(period_generator_tests, regions_and_end_of_pattern) {
+  Pattern pattern;
+  pattern.periods = {{3}, {7}};
+  pattern.segments = {{2, 0, Segment::kHalted}, {3, 1, Segment::kRunning}, {1, 1, Segment::kKeepAlive}};
+  PatternGenerator generator(pattern);
+  auto bocs = GenerateAll(generator, 4);
+
+  ASSERT_EQ(7u, bocs.size());
+  EXPECT_TRUE(generator.Done());
+  EXPECT_TRUE(bocs[0].is_halted);
+  EXPECT_FALSE(bocs[0].is_running);
+  EXPECT_EQ(3u, bocs[1].residue);
+  EXPECT_TRUE(bocs[2].is_running);
+  EXPECT_EQ(7u, bocs[2].residue);
+  EXPECT_TRUE(bocs[5].is_running);
+  EXPECT_TRUE(bocs[5].in_KA);
+  EXPECT_TRUE(bocs[6].is_halted);
+  for (uint32_t i = 0; i < bocs.size(); ++i) EXPECT_EQ(i, bocs[i].boc_count);
+}
+
+TEST(period_generator_tests, type_sequence_and_repeat_are_batch_independent) {
+  Pattern pattern;
+  pattern.periods = {{0}};
+  Segment segment = {5};
+  segment.type_sequence = 0b01;  // B A B A ... from a 2 entry sequence, bit 0 (BOC_B) first
+  segment.type_sequence_len = 2;
+  pattern.segments = {segment};
+  pattern.repeat = 3;
+
+  PatternGenerator one_by_one(pattern);
+  PatternGenerator batched(pattern);
+  auto a = GenerateAll(one_by_one, 1);
+  auto b = GenerateAll(batched, 1000);
+
+  ASSERT_EQ(16u, a.size());
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].type, b[i].type);
+    EXPECT_EQ(a[i].boc_count, b[i].boc_count);
+  }
+  EXPECT_EQ(Transaction::BOC_B, a[0].type);
+  EXPECT_EQ(Transaction::BOC_A, a[1].type);
+  EXPECT_EQ(Transaction::BOC_B, a[4].type);
+  EXPECT_EQ(Transaction::BOC_B, a[5].type);  // Sequence restarts with every segment
+}
+
+TEST(period_generator_tests, patterns_overflowing_the_boc_count_are_rejected) {
+  Pattern pattern;
+  pattern.periods = {{0}};
+  pattern.segments = {{uint64_t{1} << 31}};
+  pattern.repeat = 2;  // 2^32 BOCs plus the end marker
+
+  // Report the error instead of throwing it out of the logger
+  const auto actions = sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, sc_core::SC_DISPLAY);
+  const auto errors = sc_core::sc_report_handler::get_count(sc_core::SC_ERROR);
+  PatternGenerator generator(pattern);
+  sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, actions);
+  EXPECT_EQ(errors + 1, sc_core::sc_report_handler::get_count(sc_core::SC_ERROR));
+
+  auto bocs = GenerateAll(generator, 4);
+  ASSERT_EQ(1u, bocs.size());
+  EXPECT_TRUE(bocs[0].is_halted);
+  EXPECT_TRUE(generator.Done());
+}
+}  // namespace
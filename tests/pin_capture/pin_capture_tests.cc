@@ -2,7 +2,9 @@
 
 #include "gtest/gtest.h"
 #include "libs/scp/report/include/scp/report.h"
+#include "models/pin_capture/multi_pin.h"
 #include "models/pin_capture/pin_capture.h"
+#include "models/pin_capture/standalone.h"
 #include "systemc.h"
 
 // SystemC has its own `main` and the entry point needs to be sc_main
@@ -25,6 +27,8 @@ int sc_main(int argc, char* argv[]) {
 }
 
 namespace {
+using ::testing::_;
+using ::testing::Invoke;
 using ::testing::Return;
 
 class MockPinCapture : public pin_capture::Reference {
@@ -33,6 +37,8 @@ public:
   };
   MOCK_METHOD((period_generator::Transaction), AwaitBoc, (), (override));
   MOCK_METHOD((state_bus::Transaction), GetStateBusTransaction, (), (override));
+  MOCK_METHOD(void, EmitTransactions, (const pin_capture::Transaction*, size_t), (override));
+  MOCK_METHOD(void, Resume, (), (override));
 };
 
 TEST(pin_capture_tests, name) {
@@ -49,6 +55,107 @@ TEST(pin_capture_tests, minimal_pattern_with_default_period) {
       .WillOnce(Return(boc_halted))
       .WillOnce(Return(boc_running))
       .WillRepeatedly(Return(boc_halted));
+  EXPECT_CALL(pin_capture, EmitTransactions(_, 1)).Times(1);
   pin_capture.Start();
 }
-} // namespace
\ No newline at end of file
+
+TEST(pin_capture_tests, running_bocs_are_emitted_in_batches) {
+  const size_t running = pin_capture::Reference::kEmitBatchSize + 3;
+  period_generator::Transaction boc_halted = {.is_halted = true};
+  period_generator::Transaction boc_running = {.type = period_generator::Transaction::BOC_B, .in_KA = true,
+                                               .is_running = true, .residue = 5};
+  state_bus::Transaction state_bus = {.boc_a_count = 2, .in_keep_alive = 0};
+  MockPinCapture pin_capture;
+  auto& await = EXPECT_CALL(pin_capture, AwaitBoc()).Times(running + 1);
+  for (size_t i = 0; i < running; ++i) await.WillOnce(Return(boc_running));
+  await.WillOnce(Return(boc_halted));
+  EXPECT_CALL(pin_capture, GetStateBusTransaction()).Times(running).WillRepeatedly(Return(state_bus));
+
+  std::vector<size_t> batches;
+  std::vector<uint32_t> data;
+  EXPECT_CALL(pin_capture, EmitTransactions(_, _))
+      .WillRepeatedly([&](const pin_capture::Transaction* transactions, size_t n) {
+        batches.push_back(n);
+        for (size_t i = 0; i < n; ++i) data.push_back(transactions[i].data);
+      });
+  pin_capture.Start();
+
+  EXPECT_EQ(std::vector<size_t>({pin_capture::Reference::kEmitBatchSize, 3}), batches);
+  // The capture word layout is a placeholder until there is a device format (see Algorithm::Capture), so only check
+  // that every BOC was captured, not what the word looks like
+  EXPECT_EQ(std::vector<uint32_t>(running, pin_capture::Algorithm::Capture(boc_running, state_bus).data), data);
+}
+
+TEST(pin_capture_tests, standalone_matches_reference) {
+  period_generator::Pattern pattern;
+  pattern.periods = {{3}, {17}};
+  pattern.segments = {{.cycles = 4, .region = period_generator::Segment::kHalted},
+                      {.cycles = 150, .period = 1, .type_sequence = 0b0110, .type_sequence_len = 4},
+                      {.cycles = 20, .period = 0, .region = period_generator::Segment::kKeepAlive}};
+  std::vector<period_generator::Transaction> bocs(256);
+  bocs.resize(period_generator::PatternGenerator(pattern).Generate(bocs.data(), bocs.size()));
+  std::vector<state_bus::Transaction> state_bus(bocs.size());
+  for (size_t i = 0; i < state_bus.size(); ++i) state_bus[i] = {static_cast<uint32_t>(i * 7), (i / 16) & 1u};
+
+  std::vector<uint32_t> standalone;
+  pin_capture::RunStandalone(bocs.data(), bocs.size(), state_bus.data(), state_bus.size(),
+                             [&](const pin_capture::Transaction* transactions, size_t n) {
+                               for (size_t i = 0; i < n; ++i) standalone.push_back(transactions[i].data);
+                             });
+
+  std::vector<uint32_t> reference;
+  size_t next_boc = 0, next_state_bus = 0;
+  MockPinCapture pin_capture;
+  ON_CALL(pin_capture, AwaitBoc()).WillByDefault(Invoke([&] { return bocs.at(next_boc++); }));
+  ON_CALL(pin_capture, GetStateBusTransaction()).WillByDefault(Invoke([&] { return state_bus.at(next_state_bus++); }));
+  ON_CALL(pin_capture, EmitTransactions(_, _))
+      .WillByDefault(Invoke([&](const pin_capture::Transaction* transactions, size_t n) {
+        for (size_t i = 0; i < n; ++i) reference.push_back(transactions[i].data);
+      }));
+  pin_capture.Start();
+
+  // Both sides use the placeholder capture word, so this checks that they agree, not that the words are right
+  EXPECT_EQ(170u, standalone.size());
+  EXPECT_EQ(reference, standalone);
+}
+
+TEST(pin_capture_tests, multi_pin_compare_kernels_agree) {
+  const size_t pins = 300;
+  pin_capture::MultiPinTransaction transaction = {7, pin_capture::PinPlane(pins), pin_capture::PinPlane(pins),
+                                                  pin_capture::PinPlane(pins)};
+  size_t failing = 0;
+  for (size_t pin = 0; pin < pins; ++pin) {
+    transaction.captured.Set(pin, pin % 3 == 0);
+    transaction.expected.Set(pin, pin % 5 == 0);
+    transaction.mask.Set(pin, pin % 7 != 0);
+    failing += (pin % 3 == 0) != (pin % 5 == 0) && pin % 7 != 0;
+  }
+  EXPECT_EQ(8u, transaction.captured.Words());
+
+  pin_capture::PinPlane fail;
+  EXPECT_EQ(failing, pin_capture::CompareCapture(transaction, fail));
+  for (auto level : {pin_capture::SimdLevel::kScalar, pin_capture::SimdLevel::kSse2, pin_capture::SimdLevel::kAvx2}) {
+    pin_capture::PinPlane level_fail(pins);
+    EXPECT_EQ(failing, pin_capture::CompareCapture(transaction.captured.Data(), transaction.expected.Data(),
+                                                   transaction.mask.Data(), level_fail.Data(), level_fail.Words(),
+                                                   level));
+    for (size_t pin = 0; pin < pins; ++pin) EXPECT_EQ(fail.Get(pin), level_fail.Get(pin)) << "pin " << pin;
+  }
+}
+
+TEST(pin_capture_tests, multi_pin_compare_rejects_mismatched_planes) {
+  pin_capture::MultiPinTransaction transaction = {3, pin_capture::PinPlane(300), pin_capture::PinPlane(300),
+                                                  pin_capture::PinPlane(40)};
+  pin_capture::PinPlane fail;
+
+  // Report the error instead of throwing it out of the logger
+  const auto actions = sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, sc_core::SC_DISPLAY);
+  const auto errors = sc_core::sc_report_handler::get_count(sc_core::SC_ERROR);
+  EXPECT_EQ(300u, pin_capture::CompareCapture(transaction, fail));
+  sc_core::sc_report_handler::set_actions(sc_core::SC_ERROR, actions);
+
+  EXPECT_EQ(errors + 1, sc_core::sc_report_handler::get_count(sc_core::SC_ERROR));
+  EXPECT_EQ(300u, fail.Pins());
+  for (size_t pin = 0; pin < fail.Pins(); ++pin) EXPECT_TRUE(fail.Get(pin)) << "pin " << pin;
+}
+} // namespace
@@ -0,0 +1,74 @@
+#include <gmock/gmock.h>
+
+#include <vector>
+
+#include "base/channel.h"
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "models/pin_capture/pin_capture.h"
+#include "models/pin_capture/standalone.h"
+#include "systemc.h"
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(scp::LogConfig()
+                    .logLevel(scp::log::WARNING)
+                    .logAsync(false)
+                    .printSimTime(false));
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+// The agent is a module, so it has to exist before the first sc_start. That leaves room for a single simulation per
+// process, hence a binary of its own.
+TEST(pin_capture_agent_tests, method_agent_matches_standalone) {
+  period_generator::Pattern pattern;
+  pattern.periods = {{3}, {17}};
+  pattern.segments = {{.cycles = 4, .region = period_generator::Segment::kHalted},
+                      {.cycles = 150, .period = 1, .type_sequence = 0b0110, .type_sequence_len = 4},
+                      {.cycles = 20, .period = 0, .region = period_generator::Segment::kKeepAlive}};
+  std::vector<period_generator::Transaction> bocs(256);
+  bocs.resize(period_generator::PatternGenerator(pattern).Generate(bocs.data(), bocs.size()));
+  std::vector<state_bus::Transaction> state_bus(bocs.size());
+  for (size_t i = 0; i < state_bus.size(); ++i) state_bus[i] = {static_cast<uint32_t>(i * 7), (i / 16) & 1u};
+
+  std::vector<uint32_t> standalone;
+  pin_capture::RunStandalone(bocs.data(), bocs.size(), state_bus.data(), state_bus.size(),
+                             [&](const pin_capture::Transaction* transactions, size_t n) {
+                               for (size_t i = 0; i < n; ++i) standalone.push_back(transactions[i].data);
+                             });
+
+  // Shallow channels, a state bus that lags behind the BOCs and a slow reader make the agent stop on every input and
+  // on a full output
+  yarn::Channel<period_generator::Transaction> boc_channel("agent_bocs", 4);
+  yarn::Channel<state_bus::Transaction> state_bus_channel("agent_state_bus", 2);
+  yarn::Channel<pin_capture::Transaction> out("agent_out", 8);
+  pin_capture::ChannelReferenceAgent agent("agent", boc_channel, state_bus_channel, out);
+
+  std::vector<uint32_t> reference;
+  sc_spawn([&]() {
+    for (auto& boc : bocs) boc_channel.Put(boc);
+  });
+  sc_spawn([&]() {
+    for (auto& transaction : state_bus) {
+      wait(1, SC_NS);
+      state_bus_channel.Put(transaction);
+    }
+  });
+  sc_spawn([&]() {
+    while (reference.size() < standalone.size()) {
+      wait(3, SC_NS);
+      reference.push_back(out.Get().data);
+    }
+  });
+  sc_start(10, SC_US);
+
+  // Both sides use the placeholder capture word (see Algorithm::Capture), so this checks that they agree only
+  EXPECT_EQ(170u, standalone.size());
+  EXPECT_EQ(standalone, reference);
+  EXPECT_EQ(0u, out.Size());
+}
+}  // namespace
@@ -0,0 +1,116 @@
+#include <gmock/gmock.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "systemc.h"
+#include "tools/regression/runner.h"
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(scp::LogConfig()
+                    .logLevel(scp::log::WARNING)
+                    .logAsync(false)
+                    .printSimTime(false));
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+using yarn::regress::Job;
+using yarn::regress::Result;
+
+std::string TestDir(const std::string& test) {
+  const std::string dir = "/tmp/yarn_regress_test." + test + "." + std::to_string(getpid());
+  mkdir(dir.c_str(), 0755);
+  return dir;
+}
+
+TEST(regression_tests, manifest_resolves_paths_against_its_directory) {
+  const std::string dir = TestDir("manifest");
+  const std::string manifest = dir + "/suite.manifest";
+  {
+    std::ofstream out(manifest);
+    out << "# A comment line\n"
+        << "trace smoke bocs.trace /abs/state_bus.trace  # trailing comment\n"
+        << "\n"
+        << "cmd hello echo hello world\n";
+  }
+  std::vector<Job> jobs;
+  ASSERT_TRUE(yarn::regress::ParseManifest(manifest, jobs));
+  ASSERT_EQ(2u, jobs.size());
+  EXPECT_EQ(Job::kTrace, jobs[0].kind);
+  EXPECT_EQ("smoke", jobs[0].name);
+  EXPECT_EQ((std::vector<std::string>{dir + "/bocs.trace", "/abs/state_bus.trace"}), jobs[0].args);
+  EXPECT_EQ(Job::kCmd, jobs[1].kind);
+  EXPECT_EQ((std::vector<std::string>{"echo hello world"}), jobs[1].args);
+
+  {
+    std::ofstream out(manifest);
+    out << "trace lonely bocs.trace\n";
+  }
+  jobs.clear();
+  EXPECT_FALSE(yarn::regress::ParseManifest(manifest, jobs));
+  std::remove(manifest.c_str());
+  rmdir(dir.c_str());
+}
+
+TEST(regression_tests, collects_results_across_crashes) {
+  const std::string dir = TestDir("run");
+  // One worker, so everything after the first job runs on the worker that replaces the one it kills
+  const std::vector<Job> jobs = {
+      {Job::kCmd, "kills_worker", {"kill -KILL $PPID"}},
+      {Job::kCmd, "passes", {"echo yarn_cycles=12; echo yarn_cycles=42"}},
+      {Job::kCmd, "fails", {"exit 3"}},
+      {Job::kCmd, "crashes", {"ulimit -c 0; kill -SEGV $$"}},
+      {Job::kTrace, "no_traces", {dir + "/missing_bocs.trace", dir + "/missing_state_bus.trace"}},
+  };
+  std::vector<Result> results;
+  ASSERT_TRUE(yarn::regress::RunJobs(jobs, 1, dir, results));
+  ASSERT_EQ(jobs.size(), results.size());
+
+  EXPECT_EQ(yarn::regress::kCrash, results[0].status);
+  EXPECT_EQ("worker killed by signal 9", results[0].message);
+
+  EXPECT_EQ(yarn::regress::kPass, results[1].status);
+  EXPECT_EQ(42u, results[1].cycles);
+
+  EXPECT_EQ(yarn::regress::kFail, results[2].status);
+  EXPECT_EQ("exit status 3", results[2].message);
+
+  EXPECT_EQ(yarn::regress::kCrash, results[3].status);
+  EXPECT_EQ("killed by signal 11", results[3].message);
+
+  EXPECT_EQ(yarn::regress::kFail, results[4].status);
+  EXPECT_THAT(results[4].message, ::testing::HasSubstr("missing_bocs.trace"));
+
+  for (size_t i = 1; i < results.size(); ++i) EXPECT_GE(results[i].seconds, 0.0) << jobs[i].name;
+  for (const Job& job : jobs) std::remove((dir + "/" + job.name + ".log").c_str());
+  rmdir(dir.c_str());
+}
+
+TEST(regression_tests, every_job_gets_a_result_on_many_workers) {
+  const std::string dir = TestDir("many");
+  std::vector<Job> jobs;
+  for (int i = 0; i < 40; ++i)
+    jobs.push_back({Job::kCmd, "job" + std::to_string(i), {"echo yarn_cycles=" + std::to_string(i)}});
+  std::vector<Result> results;
+  ASSERT_TRUE(yarn::regress::RunJobs(jobs, 4, dir, results));
+  ASSERT_EQ(jobs.size(), results.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(yarn::regress::kPass, results[i].status) << jobs[i].name;
+    EXPECT_EQ(i, results[i].cycles);
+    EXPECT_LT(results[i].worker, 4);
+  }
+  for (const Job& job : jobs) std::remove((dir + "/" + job.name + ".log").c_str());
+  rmdir(dir.c_str());
+}
+}  // namespace
@@ -0,0 +1,645 @@
+#include <gmock/gmock.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "libs/scp/report/include/scp/report.h"
+#include "libs/scp/report/src/report_internal.h"
+#include "systemc.h"
+
+namespace {
+// The log file of the whole run. Death test children run sc_main again and find its name in the environment.
+std::string LogFileName() {
+  static const std::string name = []() {
+    if (const char* inherited = getenv("SCP_REPORT_TEST_LOG")) return std::string(inherited);
+    const std::string created = "/tmp/scp_report_test." + std::to_string(getpid());
+    setenv("SCP_REPORT_TEST_LOG", created.c_str(), 1);
+    return created;
+  }();
+  return name;
+}
+
+// The configuration every test starts from
+scp::LogConfig DefaultLogConfig() {
+  return scp::LogConfig()
+      .logLevel(scp::log::WARNING)
+      .logAsync(false)
+      .printSimTime(false)
+      .logFileName(LogFileName());
+}
+}  // namespace
+
+// SystemC has its own `main` and the entry point needs to be sc_main
+// So we need to initialize GoogleTest here
+int sc_main(int argc, char* argv[]) {
+  std::cout << "Running sc_main() from " << __FILE__ << std::endl;
+  testing::InitGoogleTest(&argc, argv);
+  scp::init_logging(DefaultLogConfig());
+  return RUN_ALL_TESTS();
+}
+
+namespace {
+// Collects the reports that reach sc_report_handler while it exists, instead of logging them
+class CapturedReports {
+ public:
+  struct Report {
+    sc_core::sc_severity severity;
+    std::string type;
+    std::string msg;
+  };
+
+  CapturedReports() : previous_(sc_core::sc_report_handler::get_handler()) {
+    All().clear();
+    sc_core::sc_report_handler::set_handler(&Capture);
+  }
+  ~CapturedReports() { sc_core::sc_report_handler::set_handler(previous_); }
+
+  const std::vector<Report>& Reports() const { return All(); }
+
+ private:
+  static std::vector<Report>& All() {
+    static std::vector<Report> reports;
+    return reports;
+  }
+
+  static void Capture(const sc_core::sc_report& rep, const sc_core::sc_actions&) {
+    All().push_back({rep.get_severity(), rep.get_msg_type(), rep.get_msg()});
+  }
+
+  sc_core::sc_report_handler_proc previous_;
+};
+
+// Issues one report per level and returns how many of them evaluated their message
+int ReportEveryLevel() {
+  int evaluated = 0;
+  SCP_TRACEALL("report_tests") << ++evaluated;
+  SCP_TRACE("report_tests") << ++evaluated;
+  SCP_DEBUG("report_tests") << ++evaluated;
+  SCP_INFO("report_tests") << ++evaluated;
+  SCP_WARN("report_tests") << ++evaluated;
+  return evaluated;
+}
+
+TEST(report_tests, reports_up_to_the_level_are_issued) {
+  scp::set_logging_level(scp::log::TRACEALL);
+  {
+    CapturedReports captured;
+    EXPECT_EQ(5, ReportEveryLevel());
+    EXPECT_EQ(5u, captured.Reports().size());
+  }
+  scp::set_logging_level(scp::log::WARNING);
+}
+
+TEST(report_tests, log_streambuf_spills_to_the_heap) {
+  scp::detail::log_streambuf<8> buf;
+  std::ostream os(&buf);
+  os << "abc";
+  EXPECT_EQ(3u, buf.size());
+  EXPECT_STREQ("abc", buf.c_str());
+  // Single characters go through overflow(), strings through xsputn()
+  for (char c = 'd'; c <= 'k'; ++c) os.put(c);
+  const std::string tail(100, 'x');
+  os << tail;
+  EXPECT_EQ(111u, buf.size());
+  EXPECT_EQ("abcdefghijk" + tail, buf.c_str());
+}
+
+TEST(report_tests, long_messages_are_reported_whole) {
+  const std::string text(3 * SCP_LOG_INLINE_SIZE + 1, 'm');
+  CapturedReports captured;
+  SCP_WARN("report_tests") << text.substr(0, SCP_LOG_INLINE_SIZE - 1) << text.substr(SCP_LOG_INLINE_SIZE - 1);
+  ASSERT_EQ(1u, captured.Reports().size());
+  EXPECT_EQ(text, captured.Reports()[0].msg);
+}
+
+// Issues a report of its own while the caller is still streaming
+std::string Nested(const std::string& text) {
+  SCP_WARN("report_tests.inner") << text;
+  return "nested";
+}
+
+TEST(report_tests, reports_can_be_issued_while_another_streams) {
+  const std::string text(2 * SCP_LOG_INLINE_SIZE, 'i');
+  CapturedReports captured;
+  SCP_WARN("report_tests.outer") << std::string(SCP_LOG_INLINE_SIZE - 2, 'o') << " " << Nested(text) << " done";
+  ASSERT_EQ(2u, captured.Reports().size());
+  EXPECT_EQ("report_tests.inner", captured.Reports()[0].type);
+  EXPECT_EQ(text, captured.Reports()[0].msg);
+  EXPECT_EQ("report_tests.outer", captured.Reports()[1].type);
+  EXPECT_EQ(std::string(SCP_LOG_INLINE_SIZE - 2, 'o') + " nested done", captured.Reports()[1].msg);
+}
+
+// The lines of the log file that contain text
+std::vector<std::string> LogLines(const std::string& text) {
+  std::vector<std::string> lines;
+  std::ifstream log(LogFileName());
+  for (std::string line; std::getline(log, line);)
+    if (line.find(text) != std::string::npos) lines.push_back(line);
+  return lines;
+}
+
+TEST(report_tests, deferred_infos_keep_their_order_with_warnings) {
+  scp::init_logging(DefaultLogConfig().logLevel(scp::log::INFO).logDeferred(true));
+  std::vector<std::string> expected;
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < 5; ++i) {
+      SCP_INFO("report_tests") << "ordered info " << round << "." << i;
+      expected.push_back("ordered info " + std::to_string(round) + "." + std::to_string(i));
+    }
+    // Written straight away, so it has to drain the infos queued before it
+    SCP_WARN("report_tests") << "ordered warning " << round;
+    expected.push_back("ordered warning " + std::to_string(round));
+  }
+  scp::init_logging(DefaultLogConfig());
+
+  const auto lines = LogLines("ordered ");
+  ASSERT_EQ(expected.size(), lines.size());
+  for (size_t i = 0; i < lines.size(); ++i)
+    EXPECT_NE(std::string::npos, lines[i].find(expected[i])) << lines[i] << " is not " << expected[i];
+}
+
+TEST(report_tests, deferred_infos_are_written_at_exit) {
+  // A forked child would not have the logging thread, so rerun the binary instead
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  EXPECT_EXIT(
+      {
+        scp::init_logging(DefaultLogConfig().logLevel(scp::log::INFO).logDeferred(true));
+        for (int i = 0; i < 1000; ++i) SCP_INFO("report_tests") << "exit info " << i;
+        std::exit(0);
+      },
+      testing::ExitedWithCode(0), "");
+
+  const auto lines = LogLines("exit info ");
+  ASSERT_EQ(1000u, lines.size());
+  for (int i = 0; i < 1000; ++i) EXPECT_NE(std::string::npos, lines[i].find("exit info " + std::to_string(i)));
+}
+
+// The formatting of the sim time before it was cached, kept as the reference
+std::string Time2String(sc_core::sc_time::value_type t) {
+  const std::array<const char*, 6> time_units{"fs", "ps", "ns", "us", "ms", "s "};
+  const std::array<uint64_t, 6> multiplier{1ULL,
+                                           1000ULL,
+                                           1000ULL * 1000,
+                                           1000ULL * 1000 * 1000,
+                                           1000ULL * 1000 * 1000 * 1000,
+                                           1000ULL * 1000 * 1000 * 1000 * 1000};
+  std::ostringstream oss;
+  if (!t) return "0 s ";
+  auto tr = (uint64_t)(sc_core::sc_time::from_value(1).to_seconds() * 1E15);
+  auto scale = 0U;
+  while ((tr % 10) == 0) {
+    tr /= 10;
+    scale++;
+  }
+  auto val = t;
+  auto tu = scale / 3;
+  while (tu < sc_core::SC_SEC && (val % 10) == 0) {
+    val /= 10;
+    scale++;
+    tu += (0 == (scale % 3));
+  }
+  for (scale %= 3; scale != 0; scale--) val *= 10;
+  const auto fs_val = val * multiplier[tu];
+  for (int j = multiplier.size() - 1; j >= static_cast<int>(tu); --j) {
+    if (fs_val >= multiplier[j]) {
+      oss << val / multiplier[j - tu] << '.' << std::setw(3 * (j - tu)) << std::setfill('0') << std::right
+          << val % multiplier[j - tu] << ' ' << time_units[j];
+      break;
+    }
+  }
+  return oss.str();
+}
+
+std::vector<sc_core::sc_time::value_type> SomeTimes() {
+  std::vector<sc_core::sc_time::value_type> times = {0, 1, 9, 10, 999, 1000, 1001, 1500, 999999, 1000000};
+  std::mt19937_64 random(20);
+  for (uint64_t power = 1; power <= 1000000000000ULL; power *= 10)
+    for (int i = 0; i < 50; ++i) times.push_back(power * (random() % 100000));
+  return times;
+}
+
+TEST(report_tests, time2chars_matches_time2string) {
+  for (const auto t : SomeTimes()) {
+    char text[48];
+    const auto len = scp::detail::time2chars(text, t);
+    EXPECT_EQ(Time2String(t), std::string(text, len)) << "at " << t;
+  }
+}
+
+TEST(report_tests, append_time_matches_time2string) {
+  const auto times = SomeTimes();
+  scp::detail::msg_buffer buf;
+  // Every time twice in a row, so the second one comes from the cached text
+  for (size_t i = 0; i < 2 * times.size(); ++i) {
+    const auto t = times[i / 2];
+    std::ostringstream expected;
+    expected << std::setw(20) << std::setfill(' ') << Time2String(t);
+    buf.clear();
+    scp::detail::append_time(buf, t);
+    EXPECT_EQ(expected.str(), std::string(buf.data(), buf.size())) << "at " << t;
+  }
+}
+
+TEST(report_tests, verbosity_table_tells_colliding_names_apart) {
+  scp::detail::verbosity_table table;
+  table.insert("report_tests.a", 42, sc_core::SC_LOW);
+  table.insert("report_tests.b", 42, sc_core::SC_HIGH);
+  sc_core::sc_verbosity v;
+  // Another pointer to the same text still finds its slot through the name compare
+  const std::string a = "report_tests.a";
+  ASSERT_TRUE(table.find(a.c_str(), 42, v));
+  EXPECT_EQ(sc_core::SC_LOW, v);
+  ASSERT_TRUE(table.find("report_tests.b", 42, v));
+  EXPECT_EQ(sc_core::SC_HIGH, v);
+  EXPECT_FALSE(table.find("report_tests.c", 42, v));
+  EXPECT_EQ(2u, table.size());
+
+  table.insert("report_tests.a", 42, sc_core::SC_DEBUG);
+  ASSERT_TRUE(table.find("report_tests.a", 42, v));
+  EXPECT_EQ(sc_core::SC_DEBUG, v);
+  EXPECT_EQ(2u, table.size());
+
+  table.clear();
+  EXPECT_FALSE(table.find("report_tests.a", 42, v));
+  EXPECT_EQ(0u, table.size());
+}
+
+TEST(report_tests, verbosity_table_grows) {
+  scp::detail::verbosity_table table;
+  const size_t count = scp::detail::verbosity_table::initial_capacity;
+  std::vector<std::string> names;
+  for (size_t i = 0; i < count; ++i) names.push_back("report_tests.grow" + std::to_string(i));
+  for (size_t i = 0; i < count; ++i)
+    table.insert(names[i].c_str(), scp::detail::fnv1a(names[i].c_str()) | 1, static_cast<sc_core::sc_verbosity>(i));
+  EXPECT_EQ(count, table.size());
+  EXPECT_GE(table.capacity(), 2 * scp::detail::verbosity_table::initial_capacity);
+  for (size_t i = 0; i < count; ++i) {
+    sc_core::sc_verbosity v;
+    ASSERT_TRUE(table.find(names[i].c_str(), scp::detail::fnv1a(names[i].c_str()) | 1, v)) << names[i];
+    EXPECT_EQ(static_cast<sc_core::sc_verbosity>(i), v);
+  }
+}
+
+TEST(report_tests, reinit_logging_clears_cached_verbosities) {
+  EXPECT_EQ(sc_core::SC_LOW, scp::get_log_verbosity("report_tests.reinit"));
+  // Behind the back of the cache
+  sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_DEBUG);
+  EXPECT_EQ(sc_core::SC_LOW, scp::get_log_verbosity("report_tests.reinit"));
+  scp::reinit_logging(scp::log::WARNING);
+  EXPECT_EQ(sc_core::SC_DEBUG, scp::get_log_verbosity("report_tests.reinit"));
+  scp::init_logging(DefaultLogConfig());
+  EXPECT_EQ(sc_core::SC_LOW, scp::get_log_verbosity("report_tests.reinit"));
+}
+
+TEST(report_tests, warm_log_verbosity_fills_the_cache) {
+  const std::vector<std::string> names = {"report_tests.warm.a", "report_tests.warm.b"};
+  scp::warm_log_verbosity(names);
+  sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_DEBUG);
+  // Resolved before the change, so still the old level
+  for (const auto& name : names) EXPECT_EQ(sc_core::SC_LOW, scp::get_log_verbosity(name));
+  EXPECT_EQ(sc_core::SC_DEBUG, scp::get_log_verbosity("report_tests.warm.c"));
+  scp::init_logging(DefaultLogConfig());
+}
+
+// Resolved sites are linked into a process wide list, so like the ones in the macros they have to be static
+TEST(report_tests, literal_call_sites_cache_their_level) {
+  static scp::detail::call_site site;
+  const scp::detail::check_site check{site, sc_core::SC_MEDIUM};
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+  EXPECT_FALSE(check("report_tests.site"));
+  EXPECT_EQ(sc_core::SC_LOW, site.level.load());
+
+  scp::set_logging_level(scp::log::INFO);
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+  EXPECT_TRUE(check("report_tests.site"));
+  EXPECT_EQ(sc_core::SC_MEDIUM, site.level.load());
+
+  scp::reinit_logging(scp::log::WARNING);
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+  scp::init_logging(DefaultLogConfig());
+}
+
+struct NamedModule : sc_core::sc_module {
+  explicit NamedModule(const sc_core::sc_module_name& name) : sc_core::sc_module(name) {}
+
+  bool Check(scp::detail::call_site& site) const { return scp::detail::check_site{site, sc_core::SC_LOW}(SCMOD); }
+};
+
+TEST(report_tests, non_literal_call_sites_stay_uncached) {
+  static scp::detail::call_site site;
+  const scp::detail::check_site check{site, sc_core::SC_LOW};
+  const std::string name = "report_tests.string";
+  EXPECT_TRUE(check(name));
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+  char writable[] = "report_tests.writable";
+  EXPECT_TRUE(check(writable));
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+
+  NamedModule module("report_tests_module");
+  EXPECT_TRUE(module.Check(site));
+  EXPECT_EQ(sc_core::SC_UNSET, site.level.load());
+}
+
+// Every name a logger can take its level from, in the order they were tried before the trie: most components first,
+// otherwise in the order they are generated here
+std::vector<std::string> AllCandidates(const std::string& scname, const std::vector<std::string>& features,
+                                       const std::string& type) {
+  std::multimap<size_t, std::string, std::greater<size_t>> all;
+  auto insert = [&all](const std::string& name) { all.insert({std::count(name.begin(), name.end(), '.'), name}); };
+  for (auto scn = scp::detail::split(scname); scn.size(); scn.pop_back()) {
+    for (size_t first = 0; first < scn.size(); ++first) {
+      auto scn_str = (first ? "*." : "") + scp::detail::join({scn.begin() + first, scn.end()});
+      for (auto& ft : features)
+        for (auto ftn = scp::detail::split(ft); ftn.size(); ftn.pop_back())
+          insert(scn_str + "." + scp::detail::join(ftn));
+      insert(scn_str + "." + type);
+      insert(scn_str);
+    }
+  }
+  for (auto& ft : features) {
+    for (auto ftn = scp::detail::split(ft); ftn.size(); ftn.pop_back()) {
+      insert(scp::detail::join(ftn));
+      insert("*." + scp::detail::join(ftn));
+    }
+  }
+  insert(type);
+  insert("*");
+  insert("");
+  std::vector<std::string> names;
+  for (auto& name : all) names.push_back(name.second);
+  return names;
+}
+
+std::string ParamName(const std::string& candidate) {
+  return candidate.empty() ? SCP_LOG_LEVEL_PARAM_NAME : candidate + "." SCP_LOG_LEVEL_PARAM_NAME;
+}
+
+// Resolves a logger against a trie of the given candidate names
+std::vector<std::string> Resolve(const std::vector<std::string>& params, const std::string& scname,
+                                 const std::vector<std::string>& features, const std::string& type) {
+  scp::detail::level_trie trie;
+  for (auto& param : params) trie.add(ParamName(param));
+  std::vector<std::vector<std::string>> feature_path;
+  for (auto& ft : features) feature_path.push_back(scp::detail::split(ft));
+  return trie.resolve(scp::detail::split(scname), feature_path, scp::detail::split(type));
+}
+
+TEST(report_tests, level_trie_prefers_more_components) {
+  EXPECT_EQ(std::vector<std::string>({"top.sub.leaf", "*.feat", "top", "feat", ""}),
+            Resolve({"", "feat", "top", "*.feat", "top.sub.leaf"}, "top.sub.leaf", {"feat"}, "Type"));
+}
+
+TEST(report_tests, level_trie_prefers_deeper_names) {
+  // Same number of components, the one using more of the hierarchy wins
+  EXPECT_EQ(std::vector<std::string>({"*.leaf", "top.sub"}),
+            Resolve({"top.sub", "*.leaf"}, "top.sub.leaf", {}, "Type"));
+  EXPECT_EQ(std::vector<std::string>({"top.sub.leaf", "top.sub.Type"}),
+            Resolve({"top.sub.Type", "top.sub.leaf"}, "top.sub.leaf", {}, "Type"));
+}
+
+TEST(report_tests, level_trie_prefers_earlier_start) {
+  // Same components and depth, a full name beats a wildcard
+  EXPECT_EQ(std::vector<std::string>({"top.sub.leaf", "*.sub.leaf"}),
+            Resolve({"*.sub.leaf", "top.sub.leaf"}, "top.sub.leaf", {}, "Type"));
+  EXPECT_EQ(std::vector<std::string>({"*.sub.leaf.feat", "*.leaf.feat.x"}),
+            Resolve({"*.leaf.feat.x", "*.sub.leaf.feat"}, "top.sub.leaf", {"feat.x"}, "Type"));
+}
+
+TEST(report_tests, level_trie_ranks_wildcards) {
+  EXPECT_EQ(std::vector<std::string>({"*.feat", "feat", "Type", "*", ""}),
+            Resolve({"", "*", "Type", "feat", "*.feat"}, "top", {"feat"}, "Type"));
+  // A name that does not end in log_level, or only consists of it, is not a parameter of the trie
+  scp::detail::level_trie trie;
+  trie.add("top.other");
+  trie.add("top.log_levels");
+  EXPECT_TRUE(trie.resolve({"top"}, {}, {"Type"}).empty());
+}
+
+TEST(report_tests, level_trie_matches_the_candidate_order) {
+  const std::string scname = "top.sub.leaf";
+  const std::vector<std::string> features = {"feat.x", "other"};
+  const std::string type = "ns.Type";
+  const auto all = AllCandidates(scname, features, type);
+  std::mt19937 rng(7);
+  for (int round = 0; round < 200; ++round) {
+    std::vector<std::string> params;
+    for (auto& name : all)
+      if (rng() % 4 == 0) params.push_back(name);
+    std::vector<std::string> expected;
+    for (auto& name : all)
+      if (std::find(params.begin(), params.end(), name) != params.end()) expected.push_back(name);
+    std::shuffle(params.begin(), params.end(), rng);
+    ASSERT_EQ(expected, Resolve(params, scname, features, type)) << "round " << round;
+  }
+}
+
+TEST(report_tests, first_level_skips_candidates_without_an_int) {
+  // What cci_lookup returns for each name: unset, or set to something that is not an int, yields SC_UNSET
+  const std::map<std::string, sc_core::sc_verbosity> values = {{"top.sub.leaf", sc_core::SC_UNSET},
+                                                                {"top", sc_core::SC_HIGH}};
+  auto lookup = [&values](const std::string& name) {
+    auto it = values.find(name);
+    return it == values.end() ? sc_core::SC_UNSET : it->second;
+  };
+  const auto candidates = Resolve({"", "top", "top.sub.leaf"}, "top.sub.leaf", {}, "Type");
+  ASSERT_EQ(std::vector<std::string>({"top.sub.leaf", "top", ""}), candidates);
+  EXPECT_EQ(sc_core::SC_HIGH, scp::detail::first_level(candidates, lookup));
+  EXPECT_EQ(sc_core::SC_UNSET, scp::detail::first_level({"top.sub.leaf", ""}, lookup));
+}
+
+// Just enough of a cci broker for param_index, with levels held as plain ints
+struct FakeBroker {
+  struct Handle {
+    std::string param;
+    std::string name() const { return param; }
+  };
+  std::map<std::string, int> params, presets;
+
+  std::vector<Handle> get_param_handles() const {
+    std::vector<Handle> handles;
+    for (auto& p : params) handles.push_back({p.first});
+    return handles;
+  }
+  std::vector<std::pair<std::string, int>> get_unconsumed_preset_values() const {
+    std::vector<std::pair<std::string, int>> unconsumed;
+    for (auto& p : presets)
+      if (!params.count(p.first)) unconsumed.push_back(p);
+    return unconsumed;
+  }
+
+  // What the logger cache resolves for a module, as get_log_verbosity_cached does it
+  sc_core::sc_verbosity Level(scp::detail::param_index& index, unsigned generation, const std::string& scname) {
+    auto lookup = [this](const std::string& name) {
+      const auto param = params.find(ParamName(name));
+      const auto preset = presets.find(ParamName(name));
+      if (param != params.end()) return static_cast<sc_core::sc_verbosity>(param->second);
+      return preset == presets.end() ? sc_core::SC_UNSET : static_cast<sc_core::sc_verbosity>(preset->second);
+    };
+    return scp::detail::first_level(index.update(*this, generation).resolve(scp::detail::split(scname), {}, {""}),
+                                    lookup);
+  }
+};
+
+TEST(report_tests, param_index_sees_presets_set_after_a_lookup) {
+  FakeBroker broker;
+  scp::detail::param_index index;
+  broker.params[ParamName("top")] = sc_core::SC_LOW;
+  EXPECT_EQ(sc_core::SC_LOW, broker.Level(index, 0, "top.x"));
+
+  // Set later, say by the constructor of another module, while the generation stays the same
+  broker.presets[ParamName("top.x")] = sc_core::SC_HIGH;
+  broker.presets[ParamName("*.y")] = sc_core::SC_DEBUG;
+  EXPECT_EQ(sc_core::SC_HIGH, broker.Level(index, 0, "top.x"));
+  EXPECT_EQ(sc_core::SC_DEBUG, broker.Level(index, 0, "top.y"));
+
+  // Consumed by a parameter, which the index is rebuilt from on a new generation
+  broker.params[ParamName("top.x")] = sc_core::SC_MEDIUM;
+  EXPECT_EQ(sc_core::SC_MEDIUM, broker.Level(index, 1, "top.x"));
+  EXPECT_EQ(sc_core::SC_LOW, broker.Level(index, 1, "top.z"));
+}
+
+// A class with a cached logger, which resolves its level once per generation
+struct Logged {
+  SCP_LOGGER();
+  SCP_LOGGER((named), "report_tests.logger");
+
+  int ReportInfos() {
+    int evaluated = 0;
+    SCP_INFO(()) << ++evaluated;
+    SCP_INFO((named)) << ++evaluated;
+    return evaluated;
+  }
+};
+
+TEST(report_tests, logger_members_follow_the_logging_level) {
+  Logged logged;
+  CapturedReports captured;
+  EXPECT_EQ(0, logged.ReportInfos());
+  scp::set_logging_level(scp::log::INFO);
+  EXPECT_EQ(2, logged.ReportInfos());
+  scp::set_logging_level(scp::log::WARNING);
+  EXPECT_EQ(0, logged.ReportInfos());
+  EXPECT_EQ(2u, captured.Reports().size());
+}
+
+TEST(report_tests, log_filter_matches_std_regex) {
+  // Plain alternatives, anchored and escaped ones take the literal path, the last ones fall back to std::regex
+  const std::vector<std::string> exprs = {"foo",   "FOO",    "^foo",   "foo$",   "^foo$",  "^foo|bar$", "foo|^bar$|baz",
+                                          "a\\.b", "^a\\.b$", "x\\|y",  "\\^foo", "foo\\$", "a\\\\b",    "^$",
+                                          "^",     "$",       "fo+",    "f.o|^bar", "(foo)$", "^fo[o]"};
+  const std::vector<std::string> types = {"foo", "Foo.bar", "xfoo", "foox", "bar",  "xBAR", "a.b",   "axb", "x|y",
+                                          "xy",  "^foo",    "foo$", "",     "a\\b", "ab",   "baz.F", "f-o", "fooo"};
+  for (auto& expr : exprs) {
+    scp::detail::log_filter filter;
+    filter.compile(expr);
+    const std::regex reference(expr, std::regex::extended | std::regex::icase);
+    for (auto& type : types)
+      EXPECT_EQ(std::regex_search(type, reference), filter(type.c_str())) << expr << " on " << type;
+  }
+}
+
+// Reports a debug message per type, only the ones passing the filter are written
+void ReportTypes(const std::string& prefix, int count) {
+  for (int i = 0; i < count; ++i) {
+    const auto type = prefix + std::to_string(i);
+    SCP_DEBUG(type) << "log_filter_test " << type;
+  }
+  // Warnings are not filtered and flush the log file
+  SCP_WARN("report_tests") << "log_filter_test flush";
+}
+
+TEST(report_tests, log_filter_results_are_forgotten_on_recompile) {
+  // More types than the filter remembers results for, the ones after that are matched on every report
+  scp::init_logging(DefaultLogConfig().logLevel(scp::log::DEBUG).logFilterRegex("^keep\\."));
+  ReportTypes("drop.", 4100);
+  ReportTypes("keep.", 10);
+  EXPECT_EQ(10u, LogLines("log_filter_test keep.").size());
+  EXPECT_EQ(0u, LogLines("log_filter_test drop.").size());
+
+  // The types seen before must be matched again
+  scp::init_logging(DefaultLogConfig().logLevel(scp::log::DEBUG).logFilterRegex("^drop\\.4"));
+  ReportTypes("drop.", 4100);
+  ReportTypes("keep.", 10);
+  scp::init_logging(DefaultLogConfig());
+  EXPECT_EQ(10u, LogLines("log_filter_test keep.").size());
+  // drop.4, drop.40 to drop.49, drop.400 to drop.499 and drop.4000 to drop.4099
+  EXPECT_EQ(211u, LogLines("log_filter_test drop.").size());
+}
+
+// Compile the reports below as if built with -DSCP_MIN_LOG_LEVEL=SCP_LOG_LEVEL_WARNING
+#pragma push_macro("SCP_MIN_LOG_LEVEL")
+#undef SCP_MIN_LOG_LEVEL
+#define SCP_MIN_LOG_LEVEL SCP_LOG_LEVEL_WARNING
+
+int ReportEveryLevelAboveTheFloor() {
+  int evaluated = 0;
+  SCP_TRACEALL("report_tests") << ++evaluated;
+  SCP_TRACE("report_tests") << ++evaluated;
+  SCP_DEBUG("report_tests") << ++evaluated;
+  SCP_INFO("report_tests") << ++evaluated;
+  SCP_WARN("report_tests") << ++evaluated;
+  return evaluated;
+}
+
+TEST(report_tests, min_log_level_removes_reports) {
+  static_assert(!SCP_LOG_LEVEL_ACTIVE(INFO) && SCP_LOG_LEVEL_ACTIVE(WARNING), "the floor is WARNING here");
+  // Even with everything enabled at run time only the warning is left
+  scp::set_logging_level(scp::log::TRACEALL);
+  {
+    CapturedReports captured;
+    EXPECT_EQ(1, ReportEveryLevelAboveTheFloor());
+    ASSERT_EQ(1u, captured.Reports().size());
+    EXPECT_EQ(sc_core::SC_WARNING, captured.Reports()[0].severity);
+    EXPECT_EQ("1", captured.Reports()[0].msg);
+  }
+  scp::set_logging_level(scp::log::WARNING);
+}
+
+#pragma pop_macro("SCP_MIN_LOG_LEVEL")
+
+// Runs the simulation, so it has to come after the tests that create modules
+TEST(report_tests, level_schedule_steps_in_time_order) {
+  using sc_core::SC_NS;
+  // Given out of order, applied by time. The last step lies past the end of the run.
+  scp::init_logging(DefaultLogConfig()
+                        .logLevelAt(sc_core::sc_time(20, SC_NS), scp::log::DEBUG)
+                        .logLevelAt(sc_core::sc_time(1, sc_core::SC_US), scp::log::TRACE)
+                        .logLevelAt(sc_core::sc_time(10, SC_NS), scp::log::INFO)
+                        .logLevelAt(sc_core::sc_time(30, SC_NS), scp::log::WARNING));
+  Logged logged;
+  std::vector<int> seen;
+  std::vector<sc_core::sc_verbosity> levels;
+  sc_core::sc_spawn([&]() {
+    for (int i = 0; i < 4; ++i) {
+      sc_core::wait(5, SC_NS);
+      levels.push_back(scp::get_log_verbosity());
+      seen.push_back(logged.ReportInfos());
+      sc_core::wait(5, SC_NS);
+    }
+  });
+  {
+    CapturedReports captured;
+    sc_core::sc_start();
+  }
+  // The schedule is no activity of its own: the run ends with the last process, the level it reached stays
+  EXPECT_EQ(sc_core::sc_time(40, SC_NS), sc_core::sc_time_stamp());
+  EXPECT_FALSE(sc_core::sc_pending_activity());
+  EXPECT_EQ(scp::log::WARNING, scp::get_logging_level());
+  using Levels = std::vector<sc_core::sc_verbosity>;
+  EXPECT_EQ(Levels({sc_core::SC_LOW, sc_core::SC_MEDIUM, sc_core::SC_HIGH, sc_core::SC_LOW}), levels);
+  EXPECT_EQ(std::vector<int>({0, 2, 2, 0}), seen);
+  scp::init_logging(DefaultLogConfig());
+}
+}  // namespace
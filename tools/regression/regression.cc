@@ -0,0 +1,125 @@
+// Parallel regression runner.
+//
+// SystemC allows one simulation per process, so the runner shards a suite over worker processes instead of threads.
+// The parent forks one worker per core; workers pull the next job index from an atomic counter in shared memory until
+// the manifest is exhausted, so long and short jobs balance out on their own. Each job writes its result into its own
+// slot of the same shared block, and the parent prints one aggregated report once every worker has exited. A worker
+// that crashes takes down only the job it was running; the parent marks that job and starts a replacement.
+//
+// Manifest, one job per line ('#' starts a comment, paths are relative to the manifest):
+//
+//   trace <name> <boc_trace> <state_bus_trace> [<expected_pin_capture_trace>]
+//       Runs pin_capture::RunStandalone over the recorded streams (see base/trace.h). With an expected trace the job
+//       passes only if every emitted transaction matches it.
+//   cmd <name> <shell command>
+//       Runs the command with /bin/sh and passes if it exits with 0. Its output goes to <log_dir>/<name>.log; a line
+//       "yarn_cycles=<n>" in it reports the number of simulated cycles.
+//
+// Usage: yarn_regress [-j <workers>] [--json <report.json>] [--log-dir <dir>] <manifest>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tools/regression/runner.h"
+
+namespace {
+
+using yarn::regress::Job;
+using yarn::regress::Result;
+using yarn::regress::StatusName;
+
+std::string JsonEscape(const std::string& s) {
+  std::string escaped;
+  for (char c : s) {
+    if (c == '"' || c == '\\') escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+  }
+  return escaped;
+}
+
+void Report(const std::vector<Job>& jobs, const std::vector<Result>& results, int workers, double wall,
+            const std::string& json) {
+  size_t passed = 0;
+  uint64_t cycles = 0;
+  std::cout << std::left << std::setw(32) << "job" << std::setw(8) << "status" << std::right << std::setw(14)
+            << "cycles" << std::setw(10) << "seconds" << std::setw(16) << "cycles/s" << "  message\n";
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const Result& r = results[i];
+    passed += r.status == yarn::regress::kPass;
+    cycles += r.cycles;
+    std::cout << std::left << std::setw(32) << jobs[i].name << std::setw(8) << StatusName(r.status) << std::right
+              << std::setw(14) << r.cycles << std::setw(10) << std::fixed << std::setprecision(3) << r.seconds
+              << std::setw(16) << std::setprecision(0) << (r.seconds > 0 ? r.cycles / r.seconds : 0.0) << "  "
+              << r.message << "\n";
+  }
+  std::cout << passed << "/" << jobs.size() << " passed, " << cycles << " cycles in " << std::setprecision(3) << wall
+            << " s on " << workers << " workers (" << std::setprecision(0) << (wall > 0 ? cycles / wall : 0.0)
+            << " cycles/s)\n";
+
+  if (json.empty()) return;
+  std::ofstream out(json);
+  out << "{\"workers\": " << workers << ", \"wall_s\": " << wall << ", \"passed\": " << passed
+      << ", \"failed\": " << jobs.size() - passed << ", \"cycles\": " << cycles << ", \"jobs\": [";
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const Result& r = results[i];
+    out << (i ? ",\n  " : "\n  ") << "{\"name\": \"" << JsonEscape(jobs[i].name) << "\", \"kind\": \""
+        << (jobs[i].kind == Job::kTrace ? "trace" : "cmd") << "\", \"status\": \"" << StatusName(r.status)
+        << "\", \"cycles\": " << r.cycles << ", \"seconds\": " << r.seconds << ", \"message\": \""
+        << JsonEscape(r.message) << "\"}";
+  }
+  out << "\n]}\n";
+}
+
+}  // namespace
+
+int sc_main(int argc, char* argv[]) {
+  int workers = static_cast<int>(std::thread::hardware_concurrency());
+  std::string json, log_dir = "regress_logs", manifest;
+  bool usage = false;
+  for (int i = 1; i < argc && !usage; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-j" && i + 1 < argc)
+      workers = std::atoi(argv[++i]);
+    else if (arg == "--json" && i + 1 < argc)
+      json = argv[++i];
+    else if (arg == "--log-dir" && i + 1 < argc)
+      log_dir = argv[++i];
+    else if (manifest.empty() && arg[0] != '-')
+      manifest = arg;
+    else
+      usage = true;
+  }
+  if (usage || manifest.empty()) {
+    std::cerr << "usage: " << argv[0] << " [-j <workers>] [--json <report.json>] [--log-dir <dir>] <manifest>\n";
+    return 2;
+  }
+
+  std::vector<Job> jobs;
+  if (!yarn::regress::ParseManifest(manifest, jobs)) return 2;
+  if (jobs.empty()) {
+    std::cerr << "No jobs in " << manifest << "\n";
+    return 2;
+  }
+  mkdir(log_dir.c_str(), 0755);
+  workers = std::max(1, std::min<int>(workers, jobs.size()));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<Result> results;
+  if (!yarn::regress::RunJobs(jobs, workers, log_dir, results)) return 2;
+  const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  Report(jobs, results, workers, wall, json);
+  size_t passed = 0;
+  for (const Result& r : results) passed += r.status == yarn::regress::kPass;
+  return passed == jobs.size() ? 0 : 1;
+}
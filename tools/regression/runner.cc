@@ -0,0 +1,273 @@
+#include "tools/regression/runner.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <type_traits>
+
+#include "base/trace.h"
+#include "models/pin_capture/standalone.h"
+
+namespace yarn {
+namespace regress {
+namespace {
+
+// Shared memory: a Header, then one Slot per job. Workers only ever touch the slot of the job they run.
+struct Header {
+  std::atomic<size_t> next_job{0};
+};
+
+struct Slot {
+  std::atomic<int> status{kPending};
+  int worker = 0;
+  uint64_t cycles = 0;
+  double seconds = 0;
+  char message[160] = {};
+};
+
+// Atomics shared between processes only work when they do not fall back to a lock inside the process
+static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<int>::is_always_lock_free,
+              "shared memory needs lock-free atomics");
+static_assert(std::is_trivially_destructible<Header>::value && std::is_trivially_destructible<Slot>::value,
+              "the block is unmapped without running destructors");
+
+void SetMessage(Slot& result, const std::string& message) {
+  snprintf(result.message, sizeof(result.message), "%s", message.c_str());
+}
+
+std::string Resolve(const std::string& dir, const std::string& path) {
+  return path.empty() || path[0] == '/' ? path : dir + "/" + path;
+}
+
+void RunTrace(const Job& job, Slot& result) {
+  yarn::TraceReader<period_generator::Transaction> bocs(job.args[0]);
+  yarn::TraceReader<state_bus::Transaction> state_bus(job.args[1]);
+  if (!bocs.IsOpen() || !state_bus.IsOpen()) {
+    result.status = kFail;
+    SetMessage(result, "cannot read input traces");
+    return;
+  }
+
+  if (job.args.size() < 3) {
+    uint64_t emitted = 0;
+    pin_capture::RunStandalone(bocs, state_bus, [&](const pin_capture::Transaction*, size_t n) { emitted += n; });
+    result.cycles = bocs.Size();
+    result.status = kPass;
+    SetMessage(result, std::to_string(emitted) + " transactions");
+    return;
+  }
+
+  yarn::TraceReader<pin_capture::Transaction> expected(job.args[2]);
+  if (!expected.IsOpen()) {
+    result.status = kFail;
+    SetMessage(result, "cannot read expected trace");
+    return;
+  }
+  size_t emitted = 0;
+  size_t first_mismatch = SIZE_MAX;
+  pin_capture::RunStandalone(bocs, state_bus, [&](const pin_capture::Transaction* transactions, size_t n) {
+    for (size_t i = 0; i < n; ++i, ++emitted) {
+      if (first_mismatch == SIZE_MAX &&
+          (emitted >= expected.Size() || expected[emitted].data.data != transactions[i].data))
+        first_mismatch = emitted;
+    }
+  });
+  result.cycles = bocs.Size();
+  if (first_mismatch != SIZE_MAX) {
+    result.status = kFail;
+    SetMessage(result, "mismatch at transaction " + std::to_string(first_mismatch));
+  } else if (emitted != expected.Size()) {
+    result.status = kFail;
+    SetMessage(result, std::to_string(emitted) + " transactions, expected " + std::to_string(expected.Size()));
+  } else {
+    result.status = kPass;
+    SetMessage(result, std::to_string(emitted) + " transactions");
+  }
+}
+
+void RunCmd(const Job& job, const std::string& log_dir, Slot& result) {
+  const std::string log = log_dir + "/" + job.name + ".log";
+  const pid_t pid = fork();
+  if (pid == 0) {
+    const int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      close(fd);
+    }
+    execl("/bin/sh", "sh", "-c", job.args[0].c_str(), static_cast<char*>(nullptr));
+    _exit(127);
+  }
+  int status = 0;
+  if (pid < 0 || waitpid(pid, &status, 0) < 0) {
+    result.status = kFail;
+    SetMessage(result, "cannot start command");
+    return;
+  }
+
+  // The last cycle count the command reported
+  std::ifstream in(log);
+  for (std::string line; std::getline(in, line);) {
+    const size_t at = line.find("yarn_cycles=");
+    if (at != std::string::npos) result.cycles = std::strtoull(line.c_str() + at + 12, nullptr, 10);
+  }
+
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    result.status = kPass;
+  } else {
+    result.status = WIFSIGNALED(status) ? kCrash : kFail;
+    SetMessage(result, WIFSIGNALED(status) ? "killed by signal " + std::to_string(WTERMSIG(status))
+                                           : "exit status " + std::to_string(WEXITSTATUS(status)));
+  }
+}
+
+[[noreturn]] void Worker(int worker, const std::vector<Job>& jobs, const std::string& log_dir, Header& header,
+                         Slot* slots) {
+  for (size_t i; (i = header.next_job.fetch_add(1)) < jobs.size();) {
+    Slot& result = slots[i];
+    result.worker = worker;
+    result.status = kRunning;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      if (jobs[i].kind == Job::kTrace)
+        RunTrace(jobs[i], result);
+      else
+        RunCmd(jobs[i], log_dir, result);
+    } catch (const std::exception& e) {
+      result.status = kFail;
+      SetMessage(result, e.what());
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  fflush(nullptr);
+  _exit(0);
+}
+
+}  // namespace
+
+const char* StatusName(int status) {
+  switch (status) {
+    case kPass: return "pass";
+    case kFail: return "fail";
+    case kCrash: return "crash";
+    default: return "not run";
+  }
+}
+
+bool ParseManifest(const std::string& file_name, std::vector<Job>& jobs) {
+  std::ifstream in(file_name);
+  if (!in) {
+    std::cerr << "Cannot read manifest " << file_name << "\n";
+    return false;
+  }
+  const size_t slash = file_name.rfind('/');
+  const std::string dir = slash == std::string::npos ? "." : file_name.substr(0, slash);
+
+  std::string line;
+  for (size_t line_no = 1; std::getline(in, line); ++line_no) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string kind;
+    Job job;
+    if (!(fields >> kind)) continue;
+    if (!(fields >> job.name)) {
+      std::cerr << file_name << ":" << line_no << ": missing job name\n";
+      return false;
+    }
+    if (kind == "trace") {
+      job.kind = Job::kTrace;
+      for (std::string path; fields >> path;) job.args.push_back(Resolve(dir, path));
+      if (job.args.size() < 2 || job.args.size() > 3) {
+        std::cerr << file_name << ":" << line_no << ": trace jobs take 2 or 3 trace files\n";
+        return false;
+      }
+    } else if (kind == "cmd") {
+      job.kind = Job::kCmd;
+      std::string command;
+      std::getline(fields >> std::ws, command);
+      if (command.empty()) {
+        std::cerr << file_name << ":" << line_no << ": missing command\n";
+        return false;
+      }
+      job.args.push_back(command);
+    } else {
+      std::cerr << file_name << ":" << line_no << ": unknown job kind '" << kind << "'\n";
+      return false;
+    }
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+bool RunJobs(const std::vector<Job>& jobs, int workers, const std::string& log_dir, std::vector<Result>& results) {
+  // The slots start at the first offset past the header that suits their alignment
+  const size_t slots_offset = (sizeof(Header) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+  const size_t shared_size = slots_offset + jobs.size() * sizeof(Slot);
+  void* map = mmap(nullptr, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED) {
+    std::cerr << "Cannot map " << shared_size << " bytes of shared memory\n";
+    return false;
+  }
+  Header& header = *new (map) Header;
+  Slot* slots = reinterpret_cast<Slot*>(static_cast<char*>(map) + slots_offset);
+  for (size_t i = 0; i < jobs.size(); ++i) new (slots + i) Slot;
+
+  std::vector<pid_t> pids(workers);
+  auto spawn = [&](int worker) {
+    fflush(nullptr);
+    pids[worker] = fork();
+    if (pids[worker] == 0) Worker(worker, jobs, log_dir, header, slots);
+  };
+  for (int w = 0; w < workers; ++w) spawn(w);
+
+  for (int running = workers; running;) {
+    int status = 0;
+    const pid_t pid = wait(&status);
+    if (pid < 0) break;
+    int worker = 0;
+    while (worker < workers && pids[worker] != pid) ++worker;
+    if (worker == workers) continue;
+    --running;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) continue;
+
+    // Only the job the worker was in the middle of is lost
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      Slot& r = slots[i];
+      if (r.status == kRunning && r.worker == worker) {
+        r.status = kCrash;
+        SetMessage(r, WIFSIGNALED(status) ? "worker killed by signal " + std::to_string(WTERMSIG(status))
+                                          : "worker exited with " + std::to_string(WEXITSTATUS(status)));
+      }
+    }
+    if (header.next_job.load() < jobs.size()) {
+      spawn(worker);
+      ++running;
+    }
+  }
+
+  results.resize(jobs.size());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    results[i].status = slots[i].status;
+    results[i].worker = slots[i].worker;
+    results[i].cycles = slots[i].cycles;
+    results[i].seconds = slots[i].seconds;
+    results[i].message = slots[i].message;
+  }
+  munmap(map, shared_size);
+  return true;
+}
+
+}  // namespace regress
+}  // namespace yarn
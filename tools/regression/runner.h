@@ -0,0 +1,45 @@
+#ifndef YARN_TOOLS_REGRESSION_RUNNER_H_
+#define YARN_TOOLS_REGRESSION_RUNNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The job scheduling behind yarn_regress (see regression.cc for the manifest format), apart from its command line so
+// it can be driven from tests.
+
+namespace yarn {
+namespace regress {
+
+struct Job {
+  enum Kind { kTrace, kCmd };
+  Kind kind;
+  std::string name;
+  std::vector<std::string> args;  // Trace files, or the command line
+};
+
+enum Status : int { kPending, kRunning, kPass, kFail, kCrash };
+
+struct Result {
+  int status = kPending;
+  int worker = 0;
+  uint64_t cycles = 0;
+  double seconds = 0;
+  std::string message;
+};
+
+const char* StatusName(int status);
+
+// Appends the jobs in the manifest to `jobs`. Reports the first malformed line on stderr and returns false.
+bool ParseManifest(const std::string& file_name, std::vector<Job>& jobs);
+
+// Runs the jobs on `workers` (at least one) forked worker processes and fills `results`, one per job in manifest
+// order. Command output goes to <log_dir>/<job name>.log; log_dir has to exist. A worker that dies takes down only the
+// job it was running, which is marked kCrash, and is replaced while jobs are left. Returns false, after reporting on
+// stderr, if no job could be started.
+bool RunJobs(const std::vector<Job>& jobs, int workers, const std::string& log_dir, std::vector<Result>& results);
+
+}  // namespace regress
+}  // namespace yarn
+
+#endif  // YARN_TOOLS_REGRESSION_RUNNER_H_